@@ -0,0 +1,36 @@
+#!/bin/bash
+#Compression level against throughput: rewrites the same input at each level, plus uncompressed BCF
+#as a baseline, and reports wall time, records per second and output size.
+#The tool only re-encodes records, so timings are dominated by compression (libdeflate or zlib, see the logs).
+#Usage: compression_levels.sh input.bcf [threads] [levels...]
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 input.bcf [threads] [levels...]"
+	exit 1
+fi
+
+BIN=${BIN:-$(dirname $0)/../diploidize/bin/diploidize}
+VCF=$1
+THREADS=${2:-1}
+shift $(( $# < 2 ? $# : 2 ))
+LEVELS=${@:-0 1 2 3 4 5 6 7 8 9}
+TMP=$(mktemp -d)
+NREC=$(bcftools index -n $VCF 2> /dev/null || bcftools view -H $VCF | wc -l)
+
+run() {
+	START=$(date +%s.%N)
+	$BIN --input $VCF --output $TMP/out.bcf --thread $THREADS "$@" > $TMP/log.txt || exit 1
+	END=$(date +%s.%N)
+	SEC=$(echo "$END - $START" | bc)
+	SIZE=$(stat -c %s $TMP/out.bcf)
+	printf "%-8s %-10.2f %-14.0f %.1f\n" $LABEL $SEC $(echo "$NREC / $SEC" | bc -l) $(echo "$SIZE / 1048576" | bc -l)
+}
+
+printf "%-8s %-10s %-14s %s\n" "LEVEL" "SECONDS" "RECORDS/S" "SIZE_MB"
+LABEL=u run --output-type u
+for L in $LEVELS; do
+	LABEL=$L run --output-type b --compression-level $L
+done
+echo "Backend: $(grep -o "level [0-9] / [a-z]*" $TMP/log.txt | cut -d" " -f4)"
+
+rm -r $TMP
@@ -0,0 +1,37 @@
+#!/bin/bash
+#Thread scaling of pedphasing: runs the same job with increasing thread counts,
+#reports wall times and checks that all outputs carry identical genotypes: exits with 1 when any of them
+#differs from the first run.
+#Usage: thread_scaling.sh input.bcf pedigree.txt region [threads...]
+
+if [ $# -lt 3 ]; then
+	echo "Usage: $0 input.bcf pedigree.txt region [threads...]"
+	exit 1
+fi
+
+BIN=${BIN:-$(dirname $0)/../pedphasing/bin/pedphasing}
+VCF=$1
+PED=$2
+REG=$3
+shift 3
+THREADS=${@:-1 2 4 8 16}
+TMP=$(mktemp -d)
+
+printf "%-8s %-10s %-8s %s\n" "THREADS" "SECONDS" "SPEEDUP" "OUTPUT_MD5"
+for T in $THREADS; do
+	START=$(date +%s.%N)
+	$BIN --input $VCF --pedigree $PED --region $REG --output $TMP/out.T$T.bcf --thread $T > $TMP/log.T$T.txt || exit 1
+	END=$(date +%s.%N)
+	SEC=$(echo "$END - $START" | bc)
+	[ -z "$BASE" ] && BASE=$SEC
+	MD5=$(bcftools view -H $TMP/out.T$T.bcf | md5sum | cut -d" " -f1)
+	[ -z "$BASE_MD5" ] && BASE_MD5=$MD5
+	[ "$MD5" != "$BASE_MD5" ] && DIFF="$DIFF $T"
+	printf "%-8s %-10.2f %-8.2f %s\n" $T $SEC $(echo "$BASE / $SEC" | bc -l) $MD5
+done
+
+rm -r $TMP
+if [ -n "$DIFF" ]; then
+	echo "Output differs from the first run with threads:$DIFF"
+	exit 1
+fi
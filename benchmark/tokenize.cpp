@@ -0,0 +1,58 @@
+//Micro-benchmark of string_utils::split against string_utils::tokenize (+ parse) on pedigree and chain like lines.
+//Build: g++ -std=c++17 -O3 -mavx2 -mfma -I../common/src tokenize.cpp -o tokenize
+//Usage: ./tokenize [number of lines]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/string_utils.h>
+
+using namespace std;
+
+static double seconds(chrono::steady_clock::time_point t) {
+	return chrono::duration < double > (chrono::steady_clock::now() - t).count();
+}
+
+int main(int argc, char ** argv) {
+	unsigned int n_lines = (argc > 1) ? atoi(argv[1]) : 1000000;
+	string_utils stb;
+
+	//Synthetic inputs: pedigree lines (kid father mother sex) and chain alignment lines (size dt dq)
+	vector < string > ped, chain;
+	for (unsigned int l = 0 ; l < n_lines ; l ++) {
+		ped.push_back("SAMPLE_" + to_string(3 * l) + "\tSAMPLE_" + to_string(3 * l + 1) + "\tSAMPLE_" + to_string(3 * l + 2) + "\t" + to_string(l % 2 + 1));
+		chain.push_back(to_string(100 + l % 50000) + "\t" + to_string(l % 97) + "\t" + to_string(l % 89));
+	}
+
+	printf("%-10s %-26s %-10s %s\n", "INPUT", "METHOD", "SECONDS", "MLINES/S");
+	for (int input = 0 ; input < 2 ; input ++) {
+		vector < string > & lines = input ? chain : ped;
+		const char * name = input ? "chain" : "pedigree";
+		size_t check0 = 0, check1 = 0;
+
+		//Current way: one std::string per token, numbers through std::stol
+		vector < string > tokens;
+		chrono::steady_clock::time_point t = chrono::steady_clock::now();
+		for (unsigned int l = 0 ; l < n_lines ; l ++) {
+			stb.split(lines[l], tokens);
+			if (input) for (int k = 0 ; k < tokens.size() ; k ++) check0 += stol(tokens[k]);
+			else check0 += tokens[0].size() + tokens[1].size() + tokens[2].size();
+		}
+		double s0 = seconds(t);
+		printf("%-10s %-26s %-10.3f %.2f\n", name, input ? "split + stol" : "split", s0, n_lines / s0 / 1e6);
+
+		//Views into the line, numbers through std::from_chars
+		vector < string_view > views;
+		t = chrono::steady_clock::now();
+		for (unsigned int l = 0 ; l < n_lines ; l ++) {
+			stb.tokenize(lines[l], views);
+			if (input) for (int k = 0 ; k < views.size() ; k ++) { long n = 0; stb.parse(views[k], n); check1 += n; }
+			else check1 += views[0].size() + views[1].size() + views[2].size();
+		}
+		double s1 = seconds(t);
+		printf("%-10s %-26s %-10.3f %.2f\n", name, input ? "tokenize + parse" : "tokenize", s1, n_lines / s1 / 1e6);
+
+		if (check0 != check1) { printf("Results differ for %s lines\n", name); return 1; }
+	}
+	return 0;
+}
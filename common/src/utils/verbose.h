@@ -32,12 +32,14 @@
 class verbose {
 protected:
 	std::ofstream log;
+	std::ostream * screen;
 	bool verbose_on_screen;
 	bool verbose_on_log;
 	int prev_percent;
 
 public:
 	verbose() {
+		screen = &std::cout;
 		verbose_on_screen = true;
 		verbose_on_log = false;
 		prev_percent = -1;
@@ -61,58 +63,63 @@ public:
 		verbose_on_screen = false;
 	}
 
+	//Screen messages go to stderr, e.g. when data is streamed to stdout
+	void set_stderr() {
+		screen = &std::cerr;
+	}
+
 	void print(std::string s) {
-		if (verbose_on_screen) std::cout << s << std::endl;
+		if (verbose_on_screen) (*screen) << s << std::endl;
 		if (verbose_on_log) log << s << std::endl;
 	}
 
 	void ctitle(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << "\x1B[32m" << s <<  "\033[0m" << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << "\x1B[32m" << s <<  "\033[0m" << std::endl;
 		if (verbose_on_log) log << std::endl << s << std::endl;
 	}
 
 	void title(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << s << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << s << std::endl;
 		if (verbose_on_log) log << std::endl << s << std::endl;
 	}
 
 	void bullet(std::string s) {
-		if (verbose_on_screen) std::cout << "  * " << s << std::endl;
+		if (verbose_on_screen) (*screen) << "  * " << s << std::endl;
 		if (verbose_on_log) log << "  * " << s << std::endl;
 	}
 
 	void bullet2(std::string s) {
-		if (verbose_on_screen) std::cout << "      + " << s << std::endl;
+		if (verbose_on_screen) (*screen) << "      + " << s << std::endl;
 		if (verbose_on_log) log << "      + " << s << std::endl;
 	}
 
 	void warning(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << "\x1B[33m" << "WARNING: " <<  "\033[0m" << s << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << "\x1B[33m" << "WARNING: " <<  "\033[0m" << s << std::endl;
 		if (verbose_on_log) log << std::endl << "WARNING: " << s << std::endl;
 	}
 
 	void leave(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << "\x1B[33m" << "EXITED: " <<  "\033[0m" << s << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << "\x1B[33m" << "EXITED: " <<  "\033[0m" << s << std::endl;
 		if (verbose_on_log) log << std::endl << "EXITED: " << s << std::endl;
 		exit(EXIT_SUCCESS);
 	}
 
 	void error(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << "\x1B[31m" << "ERROR: " <<  "\033[0m" << s << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << "\x1B[31m" << "ERROR: " <<  "\033[0m" << s << std::endl;
 		if (verbose_on_log) log << std::endl << "ERROR: " << s << std::endl;
 		exit(EXIT_FAILURE);
 	}
 
 	void done(std::string s) {
-		if (verbose_on_screen) std::cout << std::endl << "\x1B[32m" << "DONE: " <<  "\033[0m" << s << std::endl;
+		if (verbose_on_screen) (*screen) << std::endl << "\x1B[32m" << "DONE: " <<  "\033[0m" << s << std::endl;
 		if (verbose_on_log) log << std::endl << "DONE: " << s << std::endl;
 		exit(EXIT_SUCCESS);
 	}
 
 	void wait(std::string s) {
 		if (verbose_on_screen) {
-			std::cout << s << " ...\r";
-			std::cout.flush();
+			(*screen) << s << " ...\r";
+			screen->flush();
 		}
 	}
 
@@ -121,8 +128,8 @@ public:
 			int curr_percent = int(percent * 100.0);
 			if (prev_percent > curr_percent) prev_percent = -1;
 			if (curr_percent > prev_percent) {
-				std::cout << prefix << " [" << curr_percent << "%]\r";
-				std::cout.flush();
+				(*screen) << prefix << " [" << curr_percent << "%]\r";
+				screen->flush();
 				prev_percent = curr_percent;
 			}
 		}
@@ -24,19 +24,15 @@
 
 using namespace std;
 
-#define OFILE_VCFU	0
-#define OFILE_VCFC	1
-#define OFILE_BCFC	2
-
 void diploidizer::diploidize() {
 	tac.clock();
 	string finput = options["input"].as < string > ();
 	string foutput = options["output"].as < string > ();
 	vrb.title("Reading data in [" + finput + "]");
 
-	//Opening input file
+	//Opening input file; one I/O thread pool is shared by the input and the output
+	io_pool iop(options["thread"].as < int > ());
 	bcf_srs_t * sr =  bcf_sr_init();
-	if (options["thread"].as < int > () > 1) bcf_sr_set_threads(sr, options["thread"].as < int > ());
     if (!(bcf_sr_add_reader (sr, finput.c_str()))) {
     	switch (sr->errnum) {
 		case not_bgzf: vrb.error("File not compressed with bgzip!"); break;
@@ -45,63 +41,72 @@ void diploidizer::diploidize() {
 		default : vrb.error("Unknown error!");
 		}
 	}
+	if (!iop.attach(sr)) vrb.error("Impossible to attach threads to [" + finput + "]");
     int nsamples = bcf_hdr_nsamples(sr->readers[0].header);
     vrb.bullet("#samples = " + stb.str(nsamples));
 
-	//Opening input file
-    string file_format = "w";
-	unsigned int file_type = OFILE_VCFU;
-	if (foutput.size() > 6 && foutput.substr(foutput.size()-6) == "vcf.gz") { file_format = "wz"; file_type = OFILE_VCFC; }
-	if (foutput.size() > 3 && foutput.substr(foutput.size()-3) == "bcf") { file_format = "wb"; file_type = OFILE_BCFC; }
-	htsFile * fp = hts_open(foutput.c_str(),file_format.c_str());
-	if (options["thread"].as < int > () > 1) hts_set_threads(fp, options["thread"].as < int > ());
 	bcf_hdr_t * hdr = sr->readers[0].header;
 
-	if (bcf_hdr_write(fp, hdr) < 0) vrb.error("Failing to write VCF/header in [" + foutput + "]");
+	//Opening output file
+	vcf_output_file out;
+	string otype = options.count("output-type") ? options["output-type"].as < string > () : "";
+	int level = options.count("compression-level") ? options["compression-level"].as < int > () : -1;
+	if (!out.open(foutput, hdr, &iop, options.count("write-index") > 0, otype, level)) vrb.error(out.error);
 
     // Declare arrays for data
-    int ngt_input, ngt_arr_input = 0; int * gt_arr_input = NULL;		//Input genotypes
     int * gt_arr_output = (int *)malloc(nsamples * 2 * sizeof(int));
 
-    //Read data
-	bcf1_t * line_data;
-	int line_parsed = 0;
-	while(bcf_sr_next_line (sr)) {
+    //Read data by batches of records and genotypes reused throughout the run;
+    //records left unchanged are never re-encoded, their raw BCF data goes straight to the output
+	bool keep_multi = options.count("keep-multiallelic") > 0;
+	vcf_batch batch(VCF_BATCH_SIZE, nsamples);
+	heap_meter meter;
+	int line_parsed = 0, line_raw = 0;
+	while (batch.read(sr)) {
+		for (unsigned int r = 0 ; r < batch.size() ; r ++) {
 
-		line_data =  bcf_sr_get_line(sr, 0);
+			bcf1_t * line_data = batch[r];
+			meter.step();
 
-		if (line_data->n_allele == 2) {
+			if (line_data->n_allele == 2) {
 
-			//read genotypes
-			ngt_input = bcf_get_genotypes(hdr, line_data, &gt_arr_input, &ngt_arr_input);
-			int max_ploidy = ngt_input/nsamples;
-			assert(max_ploidy == 1 || max_ploidy == 2);
+				//read genotypes
+				int max_ploidy = batch.decode(hdr, r);
+				if (max_ploidy < 1) vrb.error("No haploid or diploid GT field in record [" + string(bcf_hdr_id2name(hdr, line_data->rid)) + ":" + stb.str(line_data->pos + 1) + "]");
+				int32_t * gt_arr_input = batch.genotypes(r);
 
-			for(int i = 0 ; i < nsamples ; i ++) {
-				gt_arr_output[2 * i + 0] = gt_arr_input[max_ploidy * i + 0];
+				bool haploid = false;
+				for(int i = 0 ; i < nsamples ; i ++) {
+					gt_arr_output[2 * i + 0] = gt_arr_input[max_ploidy * i + 0];
 
-				if (max_ploidy == 1) {
-					gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 0];
-				} else if (gt_arr_input[max_ploidy * i + 1] == bcf_int32_vector_end) {
-					gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 0];
-				} else {
-					gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 1];
+					if (max_ploidy == 1) {
+						gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 0];
+						haploid = true;
+					} else if (gt_arr_input[max_ploidy * i + 1] == bcf_int32_vector_end) {
+						gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 0];
+						haploid = true;
+					} else {
+						gt_arr_output[2 * i + 1] = gt_arr_input[max_ploidy * i + 1];
+					}
 				}
-			}
 
-			bcf_update_genotypes(hdr, line_data, gt_arr_output, bcf_hdr_nsamples(hdr)*2);
-			if (bcf_write1(fp, hdr, line_data) < 0) vrb.error("Failing to write VCF/record");
+				//Fully diploid records are kept as they are
+				if (haploid) bcf_update_genotypes(hdr, line_data, gt_arr_output, bcf_hdr_nsamples(hdr)*2);
+				else line_raw ++;
+				if (!out.write(hdr, line_data)) vrb.error("Failing to write VCF/record");
+			} else if (keep_multi) {
+				if (!out.write(hdr, line_data)) vrb.error("Failing to write VCF/record");
+				line_raw ++;
+			}
+			line_parsed++;
 		}
-		line_parsed++;
 	}
-	free(gt_arr_input);
+	meter.stop();
 	free(gt_arr_output);
-	bcf_destroy1(line_data);
-	bcf_hdr_destroy(hdr);
-	if (hts_close(fp)) vrb.error("Non zero status when closing VCF/BCF file descriptor");
-	switch (file_type) {
-	case OFILE_VCFU: vrb.bullet("VCF writing [Uncompressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_VCFC: vrb.bullet("VCF writing [Compressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_BCFC: vrb.bullet("BCF writing [Compressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	}
+	if (!out.close()) vrb.error("Non zero status when closing VCF/BCF file descriptor or saving its index");
+	bcf_sr_destroy(sr);
+	vrb.bullet(out.format() + " writing [" + out.compression() + " / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+	vrb.bullet("#records written unchanged = " + stb.str(line_raw));
+	if (meter.enabled()) vrb.bullet("#heap allocations in steady state = " + meter.str());
+	if (out.indexed) vrb.bullet("Index written in [" + out.fnidx + "]");
 }
@@ -28,12 +28,22 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
 
 //BOOST INCLUDES
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 
+//HTSLIB INCLUDES
+#include <htslib/hts.h>
+#include <htslib/bgzf.h>
+#include <htslib/thread_pool.h>
+
 class input_file : public boost::iostreams::filtering_istream {
 protected:
 	std::ifstream file_descriptor;
@@ -104,4 +114,326 @@ public:
 	}
 };
 
+//Line reader over htslib BGZF: BGZF, gzip and plain text files are read by large chunks, BGZF blocks being
+//decompressed in parallel when threads are given. Lines are views into the internal buffer, without their
+//line ending, and remain valid until the next call to getline.
+class bgzf_input_file {
+protected:
+	BGZF * fp;
+	std::vector < char > buffer;
+	size_t head, tail;										//Unread data in [head, tail)
+	bool eof, failed;
+
+	//Moves the unread data at the front of the buffer and fills up the rest; the buffer grows when a line does not fit in
+	bool refill() {
+		if (eof) return false;
+		if (head == 0 && tail == buffer.size()) buffer.resize(2 * buffer.size());
+		else if (head) {
+			memmove(buffer.data(), buffer.data() + head, tail - head);
+			tail -= head;
+			head = 0;
+		}
+		ssize_t n = bgzf_read(fp, buffer.data() + tail, buffer.size() - tail);
+		if (n < 0) failed = true;
+		if (n <= 0) { eof = true; return false; }
+		tail += n;
+		return true;
+	}
+
+public:
+	//Blocks are decompressed on a shared pool when given, on a pool of nthreads otherwise
+	bgzf_input_file(std::string filename, int nthreads = 1, hts_tpool * shared = NULL, size_t buffer_size = 1 << 20) {
+		head = tail = 0;
+		eof = failed = false;
+		buffer.resize(buffer_size);
+		fp = bgzf_open(filename.c_str(), "r");
+		if (!fp || bgzf_compression(fp) != bgzf) return;
+		if (shared) { if (bgzf_thread_pool(fp, shared, 2 * hts_tpool_size(shared)) < 0) failed = true; }
+		else if (nthreads > 1 && bgzf_mt(fp, nthreads, 64) < 0) failed = true;
+	}
+
+	~bgzf_input_file() {
+		close();
+	}
+
+	bool fail() {
+		return (fp == NULL) || failed;
+	}
+
+	bool getline(std::string_view & line) {
+		if (!fp) return false;
+		size_t scanned = 0;
+		while (true) {
+			const char * nl = (const char *)memchr(buffer.data() + head + scanned, '\n', tail - head - scanned);
+			if (nl) {
+				size_t len = nl - (buffer.data() + head);
+				line = std::string_view(buffer.data() + head, len);
+				head += len + 1;
+				break;
+			}
+			scanned = tail - head;
+			if (!refill()) {
+				if (head == tail) return false;
+				line = std::string_view(buffer.data() + head, tail - head);
+				head = tail;
+				break;
+			}
+		}
+		if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+		return true;
+	}
+
+	int close() {
+		int ret = 0;
+		if (fp && bgzf_close(fp) < 0) ret = -1;
+		fp = NULL;
+		return failed ? -1 : ret;
+	}
+};
+
+class bgzf_output_file {
+protected:
+	struct bgzf_record {
+		int tid;
+		int64_t beg, end;
+		unsigned int offset;								//End of the record within the block
+	};
+
+	struct bgzf_block {
+		std::vector < char > udata;							//Uncompressed data
+		std::vector < char > cdata;							//Compressed data
+		size_t clen;
+		int level;
+		int first;											//Start of the first indexed record within the block, -1 if none
+		std::vector < bgzf_record > records;
+	};
+
+	std::string filename;
+	FILE * file_descriptor;
+	int level;
+	bool failed;
+
+	//Compression is done by the pool while blocks are written back in order
+	hts_tpool * pool;
+	hts_tpool_process * queue;
+	bool own_pool;
+	unsigned int queue_size, queue_used;
+	bgzf_block * current;
+	std::vector < bgzf_block * > spare;
+	uint64_t block_address;
+
+	//Tabix index built on the fly
+	bool indexed;
+	int32_t conf [6];
+	hts_idx_t * idx;
+	std::vector < std::string > seqnames;
+	int last_tid;
+
+	static void * compress(void * arg) {
+		bgzf_block * b = (bgzf_block *) arg;
+		b->clen = BGZF_MAX_BLOCK_SIZE;
+		if (bgzf_compress(b->cdata.data(), &b->clen, b->udata.data(), b->udata.size(), b->level) < 0) b->clen = 0;
+		return arg;
+	}
+
+	bgzf_block * get_block() {
+		bgzf_block * b;
+		if (spare.empty()) {
+			b = new bgzf_block;
+			b->udata.reserve(BGZF_BLOCK_SIZE);
+			b->cdata.resize(BGZF_MAX_BLOCK_SIZE);
+		} else { b = spare.back(); spare.pop_back(); }
+		b->udata.clear();
+		b->records.clear();
+		b->level = level;
+		b->first = -1;
+		return b;
+	}
+
+	void write_block(bgzf_block * b) {
+		if (!b->clen || fwrite(b->cdata.data(), 1, b->clen, file_descriptor) != b->clen) failed = true;
+		if (indexed) {
+			if (!idx && b->first >= 0) idx = hts_idx_init(0, HTS_FMT_TBI, (block_address << 16) | b->first, 14, 5);
+			for (int r = 0 ; r < b->records.size() ; r ++)
+				if (hts_idx_push(idx, b->records[r].tid, b->records[r].beg, b->records[r].end, (block_address << 16) | b->records[r].offset, 1) < 0) failed = true;
+		}
+		block_address += b->clen;
+		spare.push_back(b);
+	}
+
+	void collect(bool wait) {
+		hts_tpool_result * r = wait ? hts_tpool_next_result_wait(queue) : hts_tpool_next_result(queue);
+		if (!r) return;
+		bgzf_block * b = (bgzf_block *) hts_tpool_result_data(r);
+		hts_tpool_delete_result(r, 0);
+		queue_used --;
+		write_block(b);
+	}
+
+	void dispatch() {
+		if (current->udata.empty()) return;
+		if (pool) {
+			while (queue_used >= queue_size) collect(true);
+			if (hts_tpool_dispatch(pool, queue, compress, current) < 0) failed = true;
+			else queue_used ++;
+			while (queue_used) { unsigned int prev = queue_used; collect(false); if (prev == queue_used) break; }
+		} else write_block((bgzf_block *)compress(current));
+		current = get_block();
+	}
+
+	int get_tid(const char * seq, size_t len) {
+		if (last_tid < 0 || seqnames[last_tid].size() != len || seqnames[last_tid].compare(0, len, seq, len)) {
+			for (last_tid = 0 ; last_tid < seqnames.size() ; last_tid ++) if (seqnames[last_tid].size() == len && !seqnames[last_tid].compare(0, len, seq, len)) break;
+			if (last_tid == seqnames.size()) seqnames.push_back(std::string(seq, len));
+		}
+		return last_tid;
+	}
+
+	//Rebuilds the index entries of the records already present in the file
+	void reindex() {
+		BGZF * fp = bgzf_open(filename.c_str(), "r");
+		if (!fp) { failed = true; return; }
+		kstring_t str = {0, 0, NULL};
+		int64_t offset = bgzf_tell(fp);
+		while (bgzf_getline(fp, '\n', &str) >= 0) {
+			if (str.l && str.s[0] == conf[4]) { offset = bgzf_tell(fp); continue; }
+			const char * col [3] = { NULL, NULL, NULL };
+			size_t len [3] = { 0, 0, 0 };
+			int c = 1;
+			for (char * ss = str.s, * se = str.s ; se <= str.s + str.l ; se ++) {
+				if (se == str.s + str.l || *se == '\t') {
+					for (int k = 0 ; k < 3 ; k ++) if (conf[k+1] == c) { col[k] = ss; len[k] = se - ss; }
+					ss = se + 1; c ++;
+				}
+			}
+			if (!col[0] || !col[1]) { failed = true; break; }
+			int64_t beg = atol(col[1]) - 1;
+			int64_t end = col[2] ? atol(col[2]) : (beg + 1);
+			if (!idx) idx = hts_idx_init(0, HTS_FMT_TBI, offset, 14, 5);
+			if (hts_idx_push(idx, get_tid(col[0], len[0]), beg, end, bgzf_tell(fp), 1) < 0) failed = true;
+		}
+		free(str.s);
+		bgzf_close(fp);
+	}
+
+	void append(const char * data, size_t len) {
+		while (len) {
+			if (current->udata.size() == BGZF_BLOCK_SIZE) dispatch();
+			size_t n = std::min(len, (size_t)(BGZF_BLOCK_SIZE - current->udata.size()));
+			current->udata.insert(current->udata.end(), data, data + n);
+			data += n; len -= n;
+		}
+	}
+
+public:
+	std::string error;										//Why the file could not be opened
+
+	//Compression levels accepted by all compressed outputs, BGZF text or VCF/BCF: 0 to 9, negative for the default one.
+	//Returns the error to report, empty when the level is valid.
+	static std::string check_level(int level) {
+		if (level > 9) return "Compression level [" + std::to_string(level) + "] must be between 0 and 9";
+		return "";
+	}
+
+	//Columns are 1-based as in tabix; seq_col = 0 disables indexing
+	//A non negative resume offset (as returned by flush) continues a partially written file from that point
+	//Blocks are compressed on a shared pool when given, on a pool of nthreads otherwise
+	bgzf_output_file(std::string _filename, int seq_col = 0, int beg_col = 0, int end_col = 0, int nthreads = 1, int _level = -1, int64_t resume = -1, hts_tpool * shared = NULL) {
+		filename = _filename;
+		level = _level;
+		failed = false;
+		block_address = 0;
+		idx = NULL;
+		last_tid = -1;
+		indexed = (seq_col > 0);
+		conf[0] = 0; conf[1] = seq_col; conf[2] = beg_col; conf[3] = end_col; conf[4] = '#'; conf[5] = 0;		//Generic tabix preset
+		pool = NULL; queue = NULL;
+		queue_size = queue_used = 0;
+		own_pool = !shared;
+		if (shared || nthreads > 1) {
+			queue_size = 2 * (shared ? hts_tpool_size(shared) : nthreads);
+			pool = shared ? shared : hts_tpool_init(nthreads);
+			queue = pool ? hts_tpool_process_init(pool, queue_size, 0) : NULL;
+			if (!queue && pool && own_pool) hts_tpool_destroy(pool);
+			if (!queue) pool = NULL;
+		}
+		current = get_block();
+		file_descriptor = NULL;
+		error = check_level(level);
+		if (error != "") return;
+		if (resume >= 0) {
+			if (truncate(filename.c_str(), resume)) { error = "Cannot resume [" + filename + "]"; return; }
+			if (indexed) reindex();
+			file_descriptor = fopen(filename.c_str(), "ab");
+			block_address = resume;
+		} else file_descriptor = fopen(filename.c_str(), "wb");
+		if (!file_descriptor) error = "Cannot open [" + filename + "] for writing";
+	}
+
+	~bgzf_output_file() {
+		close();
+		delete current;
+		for (int b = 0 ; b < spare.size() ; b ++) delete spare[b];
+	}
+
+	bool fail() {
+		return (file_descriptor == NULL) || failed;
+	}
+
+	//Unindexed data such as header lines
+	void write(const std::string & data) {
+		append(data.c_str(), data.size());
+	}
+
+	//Indexed record spanning [beg, end) in 0-based coordinates; must be a full line
+	void write(const std::string & seq, int64_t beg, int64_t end, const std::string & data) {
+		if (!indexed) { append(data.c_str(), data.size()); return; }
+		get_tid(seq.c_str(), seq.size());
+		//Keep short records within a single block
+		if (current->udata.size() + data.size() > BGZF_BLOCK_SIZE && data.size() <= BGZF_BLOCK_SIZE) dispatch();
+		if (current->udata.size() == BGZF_BLOCK_SIZE) dispatch();
+		if (!idx && current->first < 0) current->first = current->udata.size();
+		append(data.c_str(), data.size());
+		current->records.push_back(bgzf_record {last_tid, beg, end, (unsigned int)current->udata.size()});
+	}
+
+	//Writes out all pending blocks and returns the size of the file, a valid resume point
+	int64_t flush() {
+		if (!file_descriptor) return -1;
+		dispatch();
+		while (queue_used) collect(true);
+		if (fflush(file_descriptor) || fsync(fileno(file_descriptor))) failed = true;
+		return failed ? -1 : (int64_t)block_address;
+	}
+
+	int close() {
+		if (!file_descriptor) return failed ? -1 : 0;
+		dispatch();
+		while (queue_used) collect(true);
+		static const uint8_t bgzf_eof [28] = { 037, 0213, 010, 4, 0, 0, 0, 0, 0, 0377, 6, 0, 0102, 0103, 2, 0, 033, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		if (fwrite(bgzf_eof, 1, 28, file_descriptor) != 28) failed = true;
+		if (fclose(file_descriptor)) failed = true;
+		file_descriptor = NULL;
+		if (queue) { hts_tpool_process_destroy(queue); queue = NULL; }
+		if (pool && own_pool) hts_tpool_destroy(pool);
+		pool = NULL;
+		if (indexed) {
+			if (!idx) idx = hts_idx_init(0, HTS_FMT_TBI, block_address << 16, 14, 5);
+			if (!idx || hts_idx_finish(idx, block_address << 16)) failed = true;
+			else {
+				//Tabix meta: configuration followed by the NUL separated sequence names
+				std::vector < uint8_t > meta (28);
+				for (int s = 0 ; s < seqnames.size() ; s ++) meta.insert(meta.end(), seqnames[s].c_str(), seqnames[s].c_str() + seqnames[s].size() + 1);
+				int32_t l_nm = meta.size() - 28;
+				memcpy(meta.data(), conf, 24);
+				memcpy(meta.data() + 24, &l_nm, 4);
+				if (hts_idx_set_meta(idx, meta.size(), meta.data(), 1) || hts_idx_save_as(idx, filename.c_str(), NULL, HTS_FMT_TBI)) failed = true;
+			}
+			if (idx) hts_idx_destroy(idx);
+			idx = NULL;
+		}
+		return failed ? -1 : 0;
+	}
+};
+
 #endif
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _IO_POOL_H
+#define _IO_POOL_H
+
+#include <htslib/hts.h>
+#include <htslib/thread_pool.h>
+extern "C" {
+	#include <htslib/synced_bcf_reader.h>
+}
+
+//Single htslib thread pool shared by all the VCF/BCF files of a run, instead of one pool per file.
+//The pool must outlive the files it is attached to.
+class io_pool {
+protected:
+	htsThreadPool tp;
+	int nthreads;
+
+public:
+	//No pool is created for a single thread; qsize is the default number of blocks queued per file
+	io_pool(int _nthreads, int qsize = 0) {
+		nthreads = _nthreads;
+		tp.pool = (nthreads > 1) ? hts_tpool_init(nthreads) : NULL;
+		tp.qsize = (qsize > 0) ? qsize : 2 * nthreads;
+	}
+
+	~io_pool() {
+		if (tp.pool) hts_tpool_destroy(tp.pool);
+	}
+
+	int size() const {
+		return nthreads;
+	}
+
+	hts_tpool * get() {
+		return tp.pool;
+	}
+
+	//Input or output file; a positive qsize overrides the default queue depth
+	bool attach(htsFile * fp, int qsize = 0) {
+		if (!tp.pool) return true;
+		htsThreadPool p = { tp.pool, (qsize > 0) ? qsize : tp.qsize };
+		return hts_set_opt(fp, HTS_OPT_THREAD_POOL, &p) == 0;
+	}
+
+	//Synced reader: attach once its readers are added. The pool goes to each file, never to the reader
+	//itself, so bcf_sr_destroy closes the files without touching the pool.
+	bool attach(bcf_srs_t * sr) {
+		for (int i = 0 ; i < sr->nreaders ; i ++) if (!attach(sr->readers[i].file)) return false;
+		return true;
+	}
+};
+
+#endif
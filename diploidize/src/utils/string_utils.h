@@ -27,10 +27,19 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <regex>
 #include <algorithm>
 #include <iostream>
+#include <charconv>
+#include <type_traits>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 class string_utils {
 public:
@@ -50,7 +59,7 @@ public:
 			p_last = str.find_first_not_of(sep, p_curr);
 			p_curr = str.find_first_of(sep, p_last);
 		}
-		if (tokens.back()[tokens.back().size()-1] == '\r') tokens.back() = tokens.back().substr(0, tokens.back().size()-1);
+		if (!tokens.empty() && !tokens.back().empty() && tokens.back().back() == '\r') tokens.back().pop_back();
 		return tokens.size();
 	}
 
@@ -67,10 +76,64 @@ public:
 			p_last = str.find_first_not_of(sep, p_curr);
 			p_curr = str.find_first_of(sep, p_last);
 		}
-		if (tokens.back()[tokens.back().size()-1] == '\r') tokens.back() = tokens.back().substr(0, tokens.back().size()-1);
+		if (!tokens.empty() && !tokens.back().empty() && tokens.back().back() == '\r') tokens.back().pop_back();
 		return tokens.size();
 	}
 
+	//First position in [p, end) that holds (match = true) or does not hold (match = false) one of the separators,
+	//also given as a 256 bits table; 32 bytes are checked at once with AVX2
+	static const char * scan(const char * p, const char * end, std::string_view sep, const uint64_t * table, bool match) {
+#ifdef __AVX2__
+		for (; p + 32 <= end ; p += 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)p);
+			__m256i eq = _mm256_setzero_si256();
+			for (char c : sep) eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+			uint32_t m = _mm256_movemask_epi8(eq);
+			if (!match) m = ~m;
+			if (m) return p + __builtin_ctz(m);
+		}
+#endif
+		for (; p < end ; p ++) {
+			unsigned char c = *p;
+			if (((table[c >> 6] >> (c & 63)) & 1ULL) == match) return p;
+		}
+		return end;
+	}
+
+	//Same tokens as split, but as views into str: nothing is copied. An empty or blank str gives no token.
+	int tokenize(std::string_view str, std::vector < std::string_view > & tokens, std::string_view sep = " \t", unsigned int n_max_tokens = 1000000) {
+		tokens.clear();
+		uint64_t table [4] = { 0, 0, 0, 0 };
+		for (unsigned char c : sep) table[c >> 6] |= 1ULL << (c & 63);
+		const char * p = str.data(), * end = str.data() + str.size();
+		while (tokens.size() < n_max_tokens) {
+			p = scan(p, end, sep, table, false);
+			if (p == end) break;
+			const char * q = scan(p, end, sep, table, true);
+			tokens.emplace_back(p, q - p);
+			p = q;
+		}
+		if (!tokens.empty() && !tokens.back().empty() && tokens.back().back() == '\r') tokens.back().remove_suffix(1);
+		return tokens.size();
+	}
+
+	//Parses a whole token as a number; false when the token is not entirely a number
+	template < class T >
+	bool parse(std::string_view str, T & n) {
+		if constexpr (std::is_floating_point < T >::value) {
+			//Floating point std::from_chars is missing from older libstdc++
+			char buffer [64], * e;
+			if (str.empty() || str.size() >= 64) return false;
+			memcpy(buffer, str.data(), str.size());
+			buffer[str.size()] = 0;
+			n = strtod(buffer, &e);
+			return e == buffer + str.size();
+		} else {
+			std::from_chars_result r = std::from_chars(str.data(), str.data() + str.size(), n);
+			return r.ec == std::errc() && r.ptr == str.data() + str.size();
+		}
+	}
+
 	bool numeric(std::string & str) {
 		double n;
 		std::istringstream in(str);
@@ -94,6 +157,20 @@ public:
 		return ss.str();
 	}
 
+	//Appends a number to an existing buffer without going through a stream
+	template < class T >
+	void append(std::string & s, T n, int prec = -1) {
+		char buffer[128];
+		if constexpr (std::is_floating_point < T >::value) {
+			//Same reason as in parse: floating point std::to_chars is missing from older libstdc++
+			int l = (prec >= 0) ? snprintf(buffer, 128, "%.*f", prec, (double)n) : snprintf(buffer, 128, "%g", (double)n);
+			s.append(buffer, std::min(l, 127));
+		} else {
+			std::to_chars_result r = std::to_chars(buffer, buffer + 128, n);
+			s.append(buffer, r.ptr - buffer);
+		}
+	}
+
 	std::string findExtension ( const std::string & filename ) {
 	   auto position = filename.find_last_of ( '.' ) ;
 	   if ( position == std::string::npos )
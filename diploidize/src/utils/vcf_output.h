@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _VCF_OUTPUT_H
+#define _VCF_OUTPUT_H
+
+#include <string>
+
+#include <htslib/hts.h>
+extern "C" {
+	#include <htslib/vcf.h>
+}
+#include <utils/io_pool.h>
+#include <utils/compressed_io.h>
+
+#define OFILE_VCFU	0
+#define OFILE_VCFC	1
+#define OFILE_BCFC	2
+#define OFILE_BCFU	3
+
+//VCF/BCF output whose format is given by the file extension: *.vcf.gz, *.bcf or plain VCF otherwise,
+//unless forced with a bcftools-like type: v (VCF), z (compressed VCF), u (uncompressed BCF), b (compressed BCF).
+//"-" writes to stdout, which is meant for piping tools together, ideally as uncompressed BCF.
+//Compressed outputs can be indexed (CSI) on the fly, as records are written, and their level set from 0 to 9.
+//Compression goes through htslib, hence through libdeflate when htslib was built with it.
+class vcf_output_file {
+public:
+	std::string filename, fnidx, error;
+	htsFile * fp;
+	unsigned int type;
+	int level;
+	bool indexed;
+	unsigned long n_records;
+
+	vcf_output_file() {
+		fp = NULL;
+		type = OFILE_VCFU;
+		level = -1;
+		indexed = false;
+		n_records = 0;
+	}
+
+	~vcf_output_file() {
+		if (fp) close();
+	}
+
+	//Error open would report for these settings, empty when they are valid
+	static std::string check(std::string otype, int level = -1) {
+		if (otype != "" && otype != "v" && otype != "z" && otype != "b" && otype != "u") return "Unknown output type [" + otype + "], use v, z, u or b";
+		return bgzf_output_file::check_level(level);
+	}
+
+	//Opens the file and writes the header; on failure, error describes the problem. A negative level is htslib's default
+	bool open(std::string _filename, bcf_hdr_t * hdr, io_pool * iop = NULL, bool index = false, std::string otype = "", int _level = -1) {
+		filename = _filename;
+		error = check(otype, _level);
+		if (error != "") return false;
+		level = _level;
+		type = OFILE_VCFU;
+		if (filename.size() > 6 && filename.substr(filename.size()-6) == "vcf.gz") type = OFILE_VCFC;
+		if (filename.size() > 3 && filename.substr(filename.size()-3) == "bcf") type = OFILE_BCFC;
+		if (otype == "v") type = OFILE_VCFU;
+		else if (otype == "z") type = OFILE_VCFC;
+		else if (otype == "b") type = OFILE_BCFC;
+		else if (otype == "u") type = OFILE_BCFU;
+		std::string mode = mode_string();
+		if (index && filename == "-") { error = "Cannot index output written to stdout"; return false; }
+		if (index && (type == OFILE_VCFU || type == OFILE_BCFU)) { error = "Cannot index uncompressed output [" + filename + "], use *.vcf.gz or *.bcf"; return false; }
+		fp = hts_open(filename.c_str(), mode.c_str());
+		if (!fp) { error = "Impossible to create [" + filename + "]"; return false; }
+		//Threads only help (de)compressing BGZF blocks
+		if (iop && (type == OFILE_VCFC || type == OFILE_BCFC) && !iop->attach(fp)) { error = "Impossible to attach threads to [" + filename + "]"; return false; }
+		if (bcf_hdr_write(fp, hdr) < 0) { error = "Failed to write header of [" + filename + "]"; return false; }
+		//The index must be initialised after the header, before any record
+		indexed = index;
+		if (indexed) {
+			fnidx = filename + ".csi";
+			if (bcf_idx_init(fp, hdr, 14, fnidx.c_str()) < 0) { error = "Impossible to initialise index of [" + filename + "]"; return false; }
+		}
+		n_records = 0;
+		return true;
+	}
+
+	bool write(bcf_hdr_t * hdr, bcf1_t * rec) {
+		if (bcf_write1(fp, hdr, rec) < 0) return false;
+		n_records ++;
+		return true;
+	}
+
+	//Saves the index, if any, then closes the file
+	bool close() {
+		bool ok = true;
+		if (indexed && bcf_idx_save(fp) < 0) ok = false;
+		if (hts_close(fp)) ok = false;
+		fp = NULL;
+		return ok;
+	}
+
+	std::string mode_string() const {
+		std::string lvl = (level >= 0) ? std::string(1, '0' + level) : "";
+		switch (type) {
+		case OFILE_VCFC: return "wz" + lvl;
+		case OFILE_BCFC: return "wb" + lvl;
+		case OFILE_BCFU: return "wbu";
+		default: return "w";
+		}
+	}
+
+	std::string format() const {
+		return (type == OFILE_BCFC || type == OFILE_BCFU) ? "BCF" : "VCF";
+	}
+
+	std::string compression() const {
+		if (type == OFILE_VCFU || type == OFILE_BCFU) return "Uncompressed";
+		return "Compressed " + backend() + ((level >= 0) ? (" level " + std::to_string(level)) : "");
+	}
+
+	//Deflate implementation htslib was built with
+	static std::string backend() {
+#ifdef HTS_FEATURE_LIBDEFLATE
+		if (hts_features() & HTS_FEATURE_LIBDEFLATE) return "libdeflate";
+#endif
+		return "zlib";
+	}
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _VCF_RECORD_H
+#define _VCF_RECORD_H
+
+#include <string_view>
+
+extern "C" {
+	#include <htslib/vcf.h>
+}
+#include <utils/arena.h>
+
+//Accessors and edits of a record that do not go through std::string
+
+inline std::string_view record_contig(const bcf_hdr_t * hdr, const bcf1_t * rec) {
+	return bcf_hdr_id2name(hdr, rec->rid);
+}
+
+inline std::string_view record_allele(bcf1_t * rec, int a) {
+	bcf_unpack(rec, BCF_UN_STR);
+	return rec->d.allele[a];
+}
+
+//Swaps REF and ALT of a bi-allelic record. The alleles are staged in the arena since htslib would otherwise
+//allocate a new allele block when given pointers into the current one; the record buffers are reused.
+inline int record_swap_alleles(const bcf_hdr_t * hdr, bcf1_t * rec, bump_arena & arena) {
+	bcf_unpack(rec, BCF_UN_STR);
+	const char * alleles [2] = { arena.copy(rec->d.allele[1]), arena.copy(rec->d.allele[0]) };
+	return bcf_update_alleles(hdr, rec, alleles, 2);
+}
+
+#endif
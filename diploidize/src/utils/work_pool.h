@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _WORK_POOL_H
+#define _WORK_POOL_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//Persistent thread pool running indexed tasks with work stealing.
+//Each thread starts with a contiguous range of tasks and pops from its front;
+//idle threads steal the back half of another thread's remaining range.
+class work_pool {
+protected:
+	struct alignas(64) task_range {
+		std::atomic < uint64_t > r;				//Begin in the high 32 bits, end in the low 32 bits
+	};
+
+	unsigned int nthreads;
+	std::unique_ptr < task_range [] > ranges;
+	std::vector < std::thread > workers;
+	std::function < void (unsigned int, unsigned int) > job;
+	std::mutex mtx;
+	std::condition_variable cv_start, cv_done;
+	unsigned long generation;
+	unsigned int running;
+	bool stopping;
+
+	static uint64_t pack(uint64_t b, uint64_t e) { return (b << 32) | e; }
+
+	bool pop(unsigned int t, unsigned int & task) {
+		uint64_t v = ranges[t].r.load();
+		while (true) {
+			uint64_t b = v >> 32, e = v & 0xFFFFFFFFULL;
+			if (b >= e) return false;
+			if (ranges[t].r.compare_exchange_weak(v, pack(b + 1, e))) { task = b; return true; }
+		}
+	}
+
+	bool steal(unsigned int t, unsigned int & task) {
+		for (unsigned int k = 1 ; k < nthreads ; k ++) {
+			unsigned int victim = (t + k) % nthreads;
+			uint64_t v = ranges[victim].r.load();
+			while (true) {
+				uint64_t b = v >> 32, e = v & 0xFFFFFFFFULL;
+				if (b >= e) break;
+				uint64_t mid = b + (e - b) / 2;
+				if (ranges[victim].r.compare_exchange_weak(v, pack(b, mid))) {
+					//Own range is empty here, so no other thread is stealing from it
+					ranges[t].r.store(pack(mid + 1, e));
+					task = mid;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void work(unsigned int t) {
+		unsigned int task;
+		while (pop(t, task) || steal(t, task)) job(task, t);
+	}
+
+	void loop(unsigned int t) {
+		unsigned long seen = 0;
+		while (true) {
+			{
+				std::unique_lock < std::mutex > lock(mtx);
+				cv_start.wait(lock, [&] { return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+			}
+			work(t);
+			{
+				std::lock_guard < std::mutex > lock(mtx);
+				if (--running == 0) cv_done.notify_one();
+			}
+		}
+	}
+
+public:
+	work_pool(unsigned int _nthreads = 1) {
+		nthreads = std::max(1U, _nthreads);
+		ranges.reset(new task_range [nthreads]);
+		for (unsigned int t = 0 ; t < nthreads ; t ++) ranges[t].r.store(0);
+		generation = 0;
+		running = 0;
+		stopping = false;
+		//The calling thread acts as thread 0
+		for (unsigned int t = 1 ; t < nthreads ; t ++) workers.emplace_back(&work_pool::loop, this, t);
+	}
+
+	~work_pool() {
+		{
+			std::lock_guard < std::mutex > lock(mtx);
+			stopping = true;
+		}
+		cv_start.notify_all();
+		for (unsigned int t = 0 ; t < workers.size() ; t ++) workers[t].join();
+	}
+
+	unsigned int size() const {
+		return nthreads;
+	}
+
+	//Runs fn(task, thread) for all tasks in [0, ntasks) and returns once they are all done
+	void run(unsigned int ntasks, const std::function < void (unsigned int, unsigned int) > & fn) {
+		if (!ntasks) return;
+		job = fn;
+		for (unsigned int t = 0 ; t < nthreads ; t ++) ranges[t].r.store(pack((uint64_t)ntasks * t / nthreads, (uint64_t)ntasks * (t + 1) / nthreads));
+		if (nthreads > 1) {
+			{
+				std::lock_guard < std::mutex > lock(mtx);
+				running = nthreads - 1;
+				generation ++;
+			}
+			cv_start.notify_all();
+		}
+		work(0);
+		if (nthreads > 1) {
+			std::unique_lock < std::mutex > lock(mtx);
+			cv_done.wait(lock, [&] { return running == 0; });
+		}
+		job = nullptr;
+	}
+};
+
+#endif
@@ -32,11 +32,15 @@ void acfiller::declare_options() {
 
 	bpo::options_description opt_input ("Input files");
 	opt_input.add_options()
-			("input", bpo::value< string >(), "Input genotypes in VCF/BCF format");
+			("input", bpo::value< string >(), "Input genotypes in VCF/BCF format, - for stdin");
 
 	bpo::options_description opt_output ("Output files");
 	opt_output.add_options()
-			("output,O", bpo::value< string >(), "Output genotypes in VCF/BCF format")
+			("output,O", bpo::value< string >(), "Output genotypes in VCF/BCF format, - for stdout")
+			("output-type", bpo::value< string >(), "Output type: v (VCF), z (compressed VCF), u (uncompressed BCF) or b (compressed BCF); from the file extension by default")
+			("compression-level", bpo::value< int >(), "Compression level of the outputs, from 0 (fastest) to 9 (smallest); htslib default otherwise")
+			("write-index", "Index the compressed output (CSI) while writing it")
+			("keep-multiallelic", "Write records that are not bi-allelic unchanged instead of dropping them")
 			("log", bpo::value< string >(), "Log file");
 
 	descriptions.add(opt_base).add(opt_input).add(opt_output);
@@ -50,6 +54,9 @@ void acfiller::parse_command_line(vector < string > & args) {
 
 	if (options.count("help")) { cout << descriptions << endl; exit(0); }
 
+	//Records go to stdout: keep it clean of messages
+	if (options.count("output") && options["output"].as < string > () == "-") vrb.set_stderr();
+
 	if (options.count("log") && !vrb.open_log(options["log"].as < string > ()))
 		vrb.error("Impossible to create log file [" + options["log"].as < string > () +"]");
 
@@ -72,8 +79,12 @@ void acfiller::verbose_files() {
 	vrb.title("Files:");
 	vrb.bullet("Input VCF     : [" + options["input"].as < string > () + "]");
 	vrb.bullet("Output VCF    : [" + options["output"].as < string > () + "]");
+	if (options.count("output-type")) vrb.bullet("Output type   : [" + options["output-type"].as < string > () + "]");
+	if (options.count("write-index")) vrb.bullet("Output index  : [" + options["output"].as < string > () + ".csi]");
 }
 
 void acfiller::verbose_options() {
 	vrb.title("Parameters:");
+	if (options.count("compression-level")) vrb.bullet("Compression   : [level " + stb.str(options["compression-level"].as < int > ()) + " / " + vcf_output_file::backend() + "]");
+	if (options.count("keep-multiallelic")) vrb.bullet("Multi-allelic : [written unchanged]");
 }
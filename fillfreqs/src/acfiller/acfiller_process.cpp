@@ -24,19 +24,15 @@
 
 using namespace std;
 
-#define OFILE_VCFU	0
-#define OFILE_VCFC	1
-#define OFILE_BCFC	2
-
 void acfiller::fill() {
 	tac.clock();
 	string finput = options["input"].as < string > ();
 	string foutput = options["output"].as < string > ();
 	vrb.title("Reading data in [" + finput + "]");
 
-	//Opening input file
+	//Opening input file; one I/O thread pool is shared by the input and the output
+	io_pool iop(options["thread"].as < int > ());
 	bcf_srs_t * sr =  bcf_sr_init();
-	if (options["thread"].as < int > () > 1) bcf_sr_set_threads(sr, options["thread"].as < int > ());
     if (!(bcf_sr_add_reader (sr, finput.c_str()))) {
     	switch (sr->errnum) {
 		case not_bgzf: vrb.error("File not compressed with bgzip!"); break;
@@ -45,68 +41,68 @@ void acfiller::fill() {
 		default : vrb.error("Unknown error!");
 		}
 	}
+	if (!iop.attach(sr)) vrb.error("Impossible to attach threads to [" + finput + "]");
     int nsamples = bcf_hdr_nsamples(sr->readers[0].header);
     vrb.bullet("#samples = " + stb.str(nsamples));
 
-	//Opening input file
-    string file_format = "w";
-	unsigned int file_type = OFILE_VCFU;
-	if (foutput.size() > 6 && foutput.substr(foutput.size()-6) == "vcf.gz") { file_format = "wz"; file_type = OFILE_VCFC; }
-	if (foutput.size() > 3 && foutput.substr(foutput.size()-3) == "bcf") { file_format = "wb"; file_type = OFILE_BCFC; }
-	htsFile * fp = hts_open(foutput.c_str(),file_format.c_str());
-	if (options["thread"].as < int > () > 1) hts_set_threads(fp, options["thread"].as < int > ());
 	bcf_hdr_t * hdr = sr->readers[0].header;
 
 	bcf_hdr_append(hdr, "##INFO=<ID=AC,Number=A,Type=Integer,Description=\"ALT allele count\">");
 	bcf_hdr_append(hdr, "##INFO=<ID=AN,Number=1,Type=Integer,Description=\"Number of alleles\">");
 
 
-	if (bcf_hdr_write(fp, hdr) < 0) vrb.error("Failing to write VCF/header in [" + foutput + "]");
-
-    // Declare arrays for data
-    int ngt, ngt_arr = 0; int * gt_arr = NULL;		//Genotype
-
-    //Read data
-	bcf1_t * line_data;
-	int line_parsed = 0;
-	while(bcf_sr_next_line (sr)) {
-
-		line_data =  bcf_sr_get_line(sr, 0);
-
-		if (line_data->n_allele == 2) {
-
-			//Swap REF and ALT
-			bcf_unpack(line_data, BCF_UN_STR);
-			string ref = string(line_data->d.allele[0]);
-			string alt = string(line_data->d.allele[1]);
-			string alleles = alt + "," + ref;
-			bcf_update_alleles_str(hdr, line_data, alleles.c_str());
-
-			//read genotypes
-			int32_t countALT = 0, countTOT = 0;
-
-			ngt = bcf_get_genotypes(hdr, line_data, &gt_arr, &ngt_arr);
-			assert(ngt == 2*nsamples);
-			for(int i = 0 ; i < 2*nsamples ; i ++) {
-				if (gt_arr[i] != bcf_gt_missing) {
-					countALT += (bcf_gt_allele(gt_arr[i])==1);
-					countTOT ++;
+	//Opening output file
+	vcf_output_file out;
+	string otype = options.count("output-type") ? options["output-type"].as < string > () : "";
+	int level = options.count("compression-level") ? options["compression-level"].as < int > () : -1;
+	if (!out.open(foutput, hdr, &iop, options.count("write-index") > 0, otype, level)) vrb.error(out.error);
+
+    //Read data by batches of records and genotypes reused throughout the run;
+    //multi-allelic records are never unpacked nor re-encoded, their raw BCF data goes straight to the output
+	bool keep_multi = options.count("keep-multiallelic") > 0;
+	vcf_batch batch(VCF_BATCH_SIZE, nsamples);
+	bump_arena arena;
+	heap_meter meter;
+	int line_parsed = 0, line_raw = 0;
+	while (batch.read(sr)) {
+		arena.reset();
+		for (unsigned int r = 0 ; r < batch.size() ; r ++) {
+
+			bcf1_t * line_data = batch[r];
+			meter.step();
+
+			if (line_data->n_allele == 2) {
+
+				//Swap REF and ALT
+				record_swap_alleles(hdr, line_data, arena);
+
+				//read genotypes
+				int32_t countALT = 0, countTOT = 0;
+
+				if (batch.decode(hdr, r) != 2) vrb.error("No diploid GT field in record [" + string(bcf_hdr_id2name(hdr, line_data->rid)) + ":" + stb.str(line_data->pos + 1) + "]");
+				int32_t * gt_arr = batch.genotypes(r);
+				for(int i = 0 ; i < 2*nsamples ; i ++) {
+					if (gt_arr[i] != bcf_gt_missing) {
+						countALT += (bcf_gt_allele(gt_arr[i])==1);
+						countTOT ++;
+					}
 				}
-			}
 
-			bcf_update_info_int32(hdr, line_data, "AC", &countALT, 1);
-			bcf_update_info_int32(hdr, line_data, "AN", &countTOT, 1);
-			if (bcf_write1(fp, hdr, line_data) < 0) vrb.error("Failing to write VCF/record");
+				bcf_update_info_int32(hdr, line_data, "AC", &countALT, 1);
+				bcf_update_info_int32(hdr, line_data, "AN", &countTOT, 1);
+				if (!out.write(hdr, line_data)) vrb.error("Failing to write VCF/record");
+			} else if (keep_multi) {
+				if (!out.write(hdr, line_data)) vrb.error("Failing to write VCF/record");
+				line_raw ++;
+			}
+			line_parsed++;
 		}
-		line_parsed++;
-	}
-	free(gt_arr);
-	bcf_destroy1(line_data);
-	bcf_hdr_destroy(hdr);
-	if (hts_close(fp)) vrb.error("Non zero status when closing VCF/BCF file descriptor");
-	switch (file_type) {
-	case OFILE_VCFU: vrb.bullet("VCF writing [Uncompressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_VCFC: vrb.bullet("VCF writing [Compressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_BCFC: vrb.bullet("BCF writing [Compressed / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
 	}
+	meter.stop();
+	if (!out.close()) vrb.error("Non zero status when closing VCF/BCF file descriptor or saving its index");
+	bcf_sr_destroy(sr);
+	vrb.bullet(out.format() + " writing [" + out.compression() + " / N=" + stb.str(nsamples) + " / L=" + stb.str(line_parsed) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+	if (keep_multi) vrb.bullet("#records written unchanged = " + stb.str(line_raw));
+	if (meter.enabled()) vrb.bullet("#heap allocations in steady state = " + meter.str());
+	if (out.indexed) vrb.bullet("Index written in [" + out.fnidx + "]");
 }
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+//Bump allocator for scratch data whose lifetime is one record or one batch: allocating is a pointer increment and
+//everything is released at once by reset(). Memory is kept across resets, in chunks that never move, so pointers
+//stay valid until the next reset and a steady state loop allocates nothing.
+class bump_arena {
+protected:
+	std::vector < std::unique_ptr < char [] > > chunks;
+	std::vector < size_t > sizes;
+	size_t chunk, used;
+
+public:
+	bump_arena(size_t capacity = 1 << 16) {
+		chunks.emplace_back(new char [capacity]);
+		sizes.push_back(capacity);
+		chunk = used = 0;
+	}
+
+	void reset() {
+		chunk = used = 0;
+	}
+
+	//n bytes aligned on align, a power of two; moves to the next chunk, added if needed, when the current one is full
+	char * alloc(size_t n, size_t align = 8) {
+		size_t offset = (used + align - 1) & ~(align - 1);
+		while (offset + n > sizes[chunk]) {
+			if (++chunk == chunks.size()) {
+				size_t capacity = std::max(2 * sizes.back(), n + align);
+				chunks.emplace_back(new char [capacity]);
+				sizes.push_back(capacity);
+			}
+			used = 0;
+			offset = 0;
+		}
+		used = offset + n;
+		return chunks[chunk].get() + offset;
+	}
+
+	//NUL terminated copy of s
+	const char * copy(std::string_view s) {
+		char * p = alloc(s.size() + 1, 1);
+		memcpy(p, s.data(), s.size());
+		p[s.size()] = 0;
+		return p;
+	}
+
+	//Bytes held, whether in use or not
+	size_t capacity() const {
+		size_t c = 0;
+		for (size_t s : sizes) c += s;
+		return c;
+	}
+};
+
+#endif
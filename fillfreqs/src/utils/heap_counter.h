@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _HEAP_COUNTER_H
+#define _HEAP_COUNTER_H
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <string>
+
+//Heap allocations counter, to check that hot loops allocate nothing in steady state. It is a benchmarking aid,
+//compiled in with make HEAP_COUNTER=1 only: it then replaces the global operator new/delete of the binary, once
+//along with the toolbox, and adds an atomic increment to every allocation. The malloc/realloc calls of C code
+//such as htslib are not seen. In release builds, heap_meter does nothing and enabled() is false.
+#ifdef __HEAP_COUNTER__
+extern std::atomic < unsigned long > heap_allocations;
+#endif
+
+//Allocations made by a loop calling step() for each record and stop() once done,
+//leaving out the first record during which buffers grow to the data
+class heap_meter {
+protected:
+	unsigned long start, stopped, n_steps;
+
+public:
+	heap_meter() {
+		start = stopped = n_steps = 0;
+	}
+
+	static constexpr bool enabled() {
+#ifdef __HEAP_COUNTER__
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void step() {
+#ifdef __HEAP_COUNTER__
+		if (n_steps ++ == 1) start = heap_allocations.load(std::memory_order_relaxed);
+#endif
+	}
+
+	void stop() {
+#ifdef __HEAP_COUNTER__
+		if (n_steps > 1) stopped = heap_allocations.load(std::memory_order_relaxed) - start;
+#endif
+	}
+
+	unsigned long count() const {
+		return stopped;
+	}
+
+	//Count as reported, n/a when there was no steady state to measure
+	std::string str() const {
+		return (n_steps > 1) ? std::to_string(stopped) : "n/a";
+	}
+};
+
+#if defined(_DECLARE_TOOLBOX_HERE) && defined(__HEAP_COUNTER__)
+	std::atomic < unsigned long > heap_allocations (0);
+
+	void * operator new(std::size_t n) {
+		heap_allocations.fetch_add(1, std::memory_order_relaxed);
+		if (void * p = std::malloc(n ? n : 1)) return p;
+		throw std::bad_alloc();
+	}
+	void * operator new(std::size_t n, std::align_val_t a) {
+		heap_allocations.fetch_add(1, std::memory_order_relaxed);
+		std::size_t al = static_cast < std::size_t > (a);
+		if (void * p = std::aligned_alloc(al, ((n ? n : 1) + al - 1) / al * al)) return p;
+		throw std::bad_alloc();
+	}
+	void * operator new(std::size_t n, const std::nothrow_t &) noexcept {
+		heap_allocations.fetch_add(1, std::memory_order_relaxed);
+		return std::malloc(n ? n : 1);
+	}
+	void * operator new[](std::size_t n) { return operator new(n); }
+	void * operator new[](std::size_t n, std::align_val_t a) { return operator new(n, a); }
+	void * operator new[](std::size_t n, const std::nothrow_t & t) noexcept { return operator new(n, t); }
+	void operator delete(void * p) noexcept { std::free(p); }
+	void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+	void operator delete(void * p, std::align_val_t) noexcept { std::free(p); }
+	void operator delete(void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+	void operator delete(void * p, const std::nothrow_t &) noexcept { std::free(p); }
+	void operator delete[](void * p) noexcept { std::free(p); }
+	void operator delete[](void * p, std::size_t) noexcept { std::free(p); }
+	void operator delete[](void * p, std::align_val_t) noexcept { std::free(p); }
+	void operator delete[](void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+	void operator delete[](void * p, const std::nothrow_t &) noexcept { std::free(p); }
+#endif
+
+#endif
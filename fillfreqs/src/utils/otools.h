@@ -69,10 +69,20 @@ extern "C" {
 #include <utils/string_utils.h>
 #include <utils/timer.h>
 #include <utils/verbose.h>
+#include <utils/work_pool.h>
+#include <utils/io_pool.h>
+#include <utils/vcf_output.h>
+#include <utils/vcf_batch.h>
+#include <utils/vcf_record.h>
+#include <utils/arena.h>
+#include <utils/heap_counter.h>
+#include <utils/sample_index.h>
 
 //TYPEDEFS
 template <typename T>
 using aligned_vector32 = std::vector<T, boost::alignment::aligned_allocator < T, 32 > >;
+template <typename T>
+using aligned_vector64 = std::vector<T, boost::alignment::aligned_allocator < T, 64 > >;
 
 //CONSTANTS
 #define RARE_VARIANT_FREQ	0.001f
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _SAMPLE_INDEX_H
+#define _SAMPLE_INDEX_H
+
+#include <vector>
+#include <string_view>
+#include <cstdint>
+
+#include <utils/arena.h>
+
+//Maps sample names to dense ids 0..n-1 in order of insertion. Names are interned once in an arena and looked up
+//by string_view, so tokens straight from a file buffer or a VCF header need no std::string. The table is open
+//addressing with linear probing, kept at most half full; each slot holds an id and the full hash of its name
+//is kept per id, so probing compares strings only when the hashes agree.
+class sample_index {
+protected:
+	bump_arena names;
+	std::vector < std::string_view > ids;
+	std::vector < uint64_t > hashes;
+	std::vector < int > slots;
+	size_t mask;
+
+	//FNV-1a, whose low bits only depend on the low bits of the characters; the final mix spreads all of them
+	//over the low bits that index the table, otherwise names differing by a few digits pile up in long runs
+	static uint64_t hash(std::string_view s) {
+		uint64_t h = 0xcbf29ce484222325ULL;
+		for (unsigned char c : s) { h ^= c; h *= 0x100000001b3ULL; }
+		h ^= h >> 33; h *= 0xff51afd7ed558ccdULL; h ^= h >> 33;
+		return h;
+	}
+
+	//Slot holding s or, if absent, the empty slot where it goes
+	size_t probe(std::string_view s, uint64_t h) const {
+		size_t i = h & mask;
+		while (slots[i] >= 0 && (hashes[slots[i]] != h || ids[slots[i]] != s)) i = (i + 1) & mask;
+		return i;
+	}
+
+	void rehash(size_t n_slots) {
+		slots.assign(n_slots, -1);
+		mask = n_slots - 1;
+		for (unsigned int id = 0 ; id < ids.size() ; id ++) {
+			size_t i = hashes[id] & mask;
+			while (slots[i] >= 0) i = (i + 1) & mask;
+			slots[i] = id;
+		}
+	}
+
+public:
+	sample_index(size_t expected = 0) : names(1 << 20) {
+		reserve(expected);
+	}
+
+	void reserve(size_t n) {
+		size_t n_slots = 16;
+		while (n_slots < 2 * n) n_slots <<= 1;
+		ids.reserve(n);
+		hashes.reserve(n);
+		if (n_slots > slots.size()) rehash(n_slots);
+	}
+
+	int size() const {
+		return ids.size();
+	}
+
+	std::string_view name(int id) const {
+		return ids[id];
+	}
+
+	//Id of s, -1 when absent
+	int find(std::string_view s) const {
+		return slots[probe(s, hash(s))];
+	}
+
+	//Id of s, inserted with the next id when absent
+	int insert(std::string_view s) {
+		uint64_t h = hash(s);
+		size_t i = probe(s, h);
+		if (slots[i] >= 0) return slots[i];
+		if (2 * (ids.size() + 1) > slots.size()) {
+			rehash(2 * slots.size());
+			i = probe(s, h);
+		}
+		slots[i] = ids.size();
+		ids.emplace_back(names.copy(s), s.size());
+		hashes.push_back(h);
+		return slots[i];
+	}
+};
+
+#endif
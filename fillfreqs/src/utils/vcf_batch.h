@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright (C) 2022-2023 Olivier Delaneau
+ * Copyright (C) 2022-2023 Simone Rubinacci
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef _VCF_BATCH_H
+#define _VCF_BATCH_H
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+extern "C" {
+	#include <htslib/vcf.h>
+	#include <htslib/synced_bcf_reader.h>
+}
+
+//Batch of consecutive records of a synced reader. Records are swapped out of the reader into a ring of bcf1_t
+//allocated once, so that htslib keeps reusing their buffers from one batch to the next. Genotypes can be decoded
+//into an int32 arena holding up to max_ploidy values per sample and record, in the layout of bcf_get_genotypes.
+//Once the ring and the buffers of its records have grown to the data, reading a batch allocates nothing.
+//The capacity is cut down so that the arena fits in VCF_BATCH_BYTES: with many samples a batch holds a few records only.
+#define VCF_BATCH_SIZE	1024
+#define VCF_BATCH_BYTES	(32UL << 20)
+
+class vcf_batch {
+protected:
+	std::vector < bcf1_t * > records;
+	std::vector < int32_t > gt;
+	std::vector < int > ploidies;
+	unsigned int n_samples, max_ploidy, n_records;
+
+	template < class T >
+	static void widen(const uint8_t * src, int32_t * dst, unsigned int n, T missing, T vector_end) {
+		const T * s = (const T *) src;
+		for (unsigned int i = 0 ; i < n ; i ++) dst[i] = (s[i] == vector_end) ? bcf_int32_vector_end : ((s[i] == missing) ? bcf_int32_missing : s[i]);
+	}
+
+public:
+	vcf_batch(unsigned int capacity, unsigned int _n_samples, unsigned int _max_ploidy = 2, size_t budget = VCF_BATCH_BYTES) {
+		n_samples = _n_samples;
+		max_ploidy = _max_ploidy;
+		n_records = 0;
+		size_t record_bytes = std::max((size_t)1, (size_t)n_samples * max_ploidy * sizeof(int32_t));
+		capacity = (unsigned int)std::max((size_t)1, std::min((size_t)capacity, budget / record_bytes));
+		records = std::vector < bcf1_t * > (capacity);
+		for (unsigned int r = 0 ; r < capacity ; r ++) records[r] = bcf_init1();
+		gt = std::vector < int32_t > ((size_t)capacity * n_samples * max_ploidy, 0);
+		ploidies = std::vector < int > (capacity, -1);
+	}
+
+	~vcf_batch() {
+		for (unsigned int r = 0 ; r < records.size() ; r ++) bcf_destroy1(records[r]);
+	}
+
+	unsigned int size() const {
+		return n_records;
+	}
+
+	unsigned int capacity() const {
+		return records.size();
+	}
+
+	bcf1_t * operator [] (unsigned int r) {
+		return records[r];
+	}
+
+	//Reads the next records of the given reader, up to capacity; returns how many, 0 once the reader is exhausted
+	unsigned int read(bcf_srs_t * sr, int reader = 0) {
+		n_records = 0;
+		while (n_records < records.size() && bcf_sr_next_line(sr)) {
+			if (!bcf_sr_has_line(sr, reader)) continue;
+			bcf_sr_swap_line(sr, reader, records[n_records]);
+			ploidies[n_records] = -1;
+			n_records ++;
+		}
+		return n_records;
+	}
+
+	//Decodes the GT field of record r into its slot of the arena; records are unpacked up to FORMAT.
+	//Returns the ploidy, -1 when there is no GT or it exceeds max_ploidy. Distinct records can be decoded concurrently.
+	int decode(bcf_hdr_t * hdr, unsigned int r) {
+		bcf1_t * rec = records[r];
+		ploidies[r] = -1;
+		bcf_unpack(rec, BCF_UN_FMT);
+		bcf_fmt_t * fmt = bcf_get_fmt(hdr, rec, "GT");
+		if (!fmt || fmt->n <= 0 || fmt->n > (int)max_ploidy) return -1;
+		int32_t * dst = genotypes(r);
+		unsigned int n = fmt->n * n_samples;
+		switch (fmt->type) {
+		case BCF_BT_INT8: widen < int8_t > (fmt->p, dst, n, bcf_int8_missing, bcf_int8_vector_end); break;
+		case BCF_BT_INT16: widen < int16_t > (fmt->p, dst, n, bcf_int16_missing, bcf_int16_vector_end); break;
+		case BCF_BT_INT32: memcpy(dst, fmt->p, n * sizeof(int32_t)); break;
+		default: return -1;
+		}
+		return (ploidies[r] = fmt->n);
+	}
+
+	//GT values of record r, ploidy(r) per sample; valid once decoded
+	int32_t * genotypes(unsigned int r) {
+		return gt.data() + (size_t)r * n_samples * max_ploidy;
+	}
+
+	int ploidy(unsigned int r) const {
+		return ploidies[r];
+	}
+};
+
+#endif
@@ -5,33 +5,24 @@
 namespace liftover {
 
 // inline void parse(std::string & line, long * coords) {
-inline void parse(std::string & line, long & size, long & target_gap, long & query_gap) {
+inline void parse(const std::vector<std::string_view> & items, long & size, long & target_gap, long & query_gap) {
   /* parse an alignment data line
   
-  line: an alignment line e.g. '5000\t10\t5' or '5000' Most lines have 3 items
+  items: the tokens of an alignment line e.g. '5000\t10\t5' or '5000' Most lines have 3 items
     (size, reference delta, query delta), but the final line has only one (size).
   */
-  // std::memset(coords, 0, 3);
+  if (!stb.parse(items[0], size)) vrb.error("Malformed alignment line in chain file");
   
-  std::istringstream iss(line);
-  std::string item;
-  
-  std::getline(iss, item, '\t');
-  size = std::stol(item);
-  
-  if (line.size() > 0) {
-    std::getline(iss, item, '\t');
-    target_gap = std::stol(item);
-    std::getline(iss, item, '\t');
-    query_gap = std::stol(item);
+  if (items.size() >= 3) {
+    if (!stb.parse(items[1], target_gap) || !stb.parse(items[2], query_gap)) vrb.error("Malformed alignment line in chain file");
   } else {
     target_gap = 0;
     query_gap = 0;
   }
 }
 
-Chain::Chain(std::string & header_line) {
-  ChainHeader header = process_header(header_line);
+Chain::Chain(const std::vector<std::string_view> & header_items) {
+  ChainHeader header = process_header(header_items);
   target_id = header.target_id;
   target = header.target_start;
   query_id = header.query_id;
@@ -42,13 +33,13 @@ Chain::Chain(std::string & header_line) {
   query_end = header.query_end;
 }
 
-void Chain::add_line(std::string & line) {
+void Chain::add_line(const std::vector<std::string_view> & items) {
   /* build a set of Intervals for mapping between coordinates.
   
   This uses the lines for a single chain. Chains for a single chromosome are
   collected together at a later stage.
   */
-  parse(line, size, target_gap, query_gap);
+  parse(items, size, target_gap, query_gap);
   
   Mapped data = Mapped {query, query + size, query_id,
     query_strand == "+", query_size};
@@ -23,7 +23,7 @@ struct Coords {
   Mapped data;
 };
 
-inline void parse(std::string & line, long * coords);
+inline void parse(const std::vector<std::string_view> & items, long & size, long & target_gap, long & query_gap);
 
 class Chain {
   // class to hold all the regions for a single chain
@@ -43,8 +43,8 @@ public:
   std::string target_id;
   
   Chain() {};
-  Chain(std::string & header_line);
-  void add_line(std::string & line);
+  Chain(const std::vector<std::string_view> & header_items);
+  void add_line(const std::vector<std::string_view> & items);
 };
 
 
@@ -9,19 +9,21 @@ std::map<std::string, Target> open_chainfile(std::string path) {
   This builds a map of Targets, indexed by chromosome, so we can quickly select
   the Target of interest when querying a given coordinate.
   */
-  input_file infile(path);
-  std::string line;
+  bgzf_input_file infile(path);
+  if (infile.fail()) vrb.error("Cannot open chain file [" + path + "]");
+  std::string_view line;
+  std::vector<std::string_view> tokens;
   std::map<std::string, std::vector<Chain>> chains;
   Chain chain;
-  while (std::getline(infile, line)) {
-    if (line[0] == '#') { continue; } // skip comment lines
+  while (infile.getline(line)) {
+    if (!line.empty() && line[0] == '#') { continue; } // skip comment lines
     
-    if (line.substr(0, 5) == "chain") {
-      chain = Chain(line);
-    } else if (line.empty()) { // finish existing chain at blank lines
+    if (stb.tokenize(line, tokens) == 0) { // finish existing chain at blank lines
       chains[chain.target_id].push_back(chain);
+    } else if (tokens[0] == "chain") {
+      chain = Chain(tokens);
     } else {
-      chain.add_line(line);
+      chain.add_line(tokens);
     }
   }
   
@@ -3,14 +3,19 @@
 
 namespace liftover {
 
-ChainHeader process_header(std::string line) {
-  /* process the header, and performs simple sanity checks
+ChainHeader process_header(const std::vector<std::string_view> & hdr) {
+  /* process the tokens of a header line, and performs simple sanity checks
   */
-  std::vector<std::string> hdr;
-  stb.split(line, hdr);
-  ChainHeader header = ChainHeader {hdr[0], std::stoll(hdr[1]), hdr[2],
-    std::stol(hdr[3]), hdr[4], std::stol(hdr[5]), std::stol(hdr[6]), hdr[7],
-    std::stol(hdr[8]), hdr[9], std::stol(hdr[10]), std::stol(hdr[11]), hdr[12]};
+  if (hdr.size() < 13) vrb.error("Malformed header line in chain file");
+  ChainHeader header = ChainHeader {std::string(hdr[0]), 0, std::string(hdr[2]),
+    0, std::string(hdr[4]), 0, 0, std::string(hdr[7]),
+    0, std::string(hdr[9]), 0, 0, std::string(hdr[12])};
+  double score = 0;
+  bool ok = stb.parse(hdr[1], score);
+  header.score = score;
+  ok = ok && stb.parse(hdr[3], header.target_size) && stb.parse(hdr[5], header.target_start) && stb.parse(hdr[6], header.target_end);
+  ok = ok && stb.parse(hdr[8], header.query_size) && stb.parse(hdr[10], header.query_start) && stb.parse(hdr[11], header.query_end);
+  if (!ok) vrb.error("Malformed header line in chain file");
   assert(header.chain == "chain");
   assert(header.target_strand == "+");
   assert(header.query_strand == "+" | header.query_strand == "-");
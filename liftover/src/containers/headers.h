@@ -22,7 +22,7 @@ struct ChainHeader {
   std::string id;
 };
 
-ChainHeader process_header(std::string line);
+ChainHeader process_header(const std::vector<std::string_view> & hdr);
 
 } // namespace
 
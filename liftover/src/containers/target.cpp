@@ -31,19 +31,26 @@ std::vector<Match> Target::query(long pos) {
   */
   std::vector<Match> matches;
   matches.reserve(1);
-  for (auto & region : tree.findOverlapping(pos, pos)) {
+  query(pos, matches);
+  return matches;
+}
+
+void Target::query(long pos, std::vector<Match> & matches) {
+  /* same, appending to a vector the caller reuses; intervals are visited in
+  place rather than copied out of the tree
+  */
+  tree.visit_overlapping(pos, [&](const Tree::interval & region) {
     if (pos == region.stop) {
-      continue;
+      return;
     }
-    Mapped & mapped = region.value;
+    const Mapped & mapped = region.value;
     long offset = pos - region.start;
     long remapped = mapped.start + offset;
     if (!mapped.fwd_strand) {
       remapped = mapped.size - remapped - 1;
     }
     matches.push_back( Match {mapped.query_id, remapped, mapped.fwd_strand});
-  }
-  return matches;
+  });
 }
 
 } //namespace
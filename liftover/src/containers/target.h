@@ -14,7 +14,7 @@ typedef IntervalTree<long, Mapped> Tree;
 
 struct Match {
   // hold info for a matched site after a successful query
-  std::string contig;
+  std::string_view contig;  // points into the Target that was queried
   long pos;
   bool fwd_strand;
 };
@@ -34,6 +34,7 @@ public:
   Target(std::vector<Chain> & chains);
   Target() {};
   std::vector<Match> query(long pos);
+  void query(long pos, std::vector<Match> & matches);
   std::vector<Match> operator[](long pos) {return query(pos);};
 };
 
@@ -40,22 +40,23 @@ void lifter::lift(vector < string > & args) {
 
 void lifter::readFasta() {
 	tac.clock();
-	string buffer;
-	vector < string > tokens;
+	string_view buffer;
+	vector < string_view > tokens;
 	string ffasta =  options["fasta"].as < string > ();
 	string schrom =  options["chr"].as < string > ();
 	bool chr_found = false;
 
 	vrb.title("Reading fasta file in [" + ffasta  + "]");
-	input_file fd(ffasta);
+	bgzf_input_file fd(ffasta, options["thread"].as < int > ());
+	if (fd.fail()) vrb.error("Cannot open fasta file [" + ffasta + "]");
 
-	while (getline(fd, buffer)) {
+	while (fd.getline(buffer)) {
+		if (buffer.empty()) continue;
 		if (buffer[0] == '>' && chr_found) break;
 		else if (buffer[0] == '>') {
-			stb.split(buffer, tokens);
-			string contig = tokens[0].substr(1);
-			if (contig == schrom) chr_found = true;
-		} else if (chr_found) refseq+=buffer;
+			stb.tokenize(buffer, tokens);
+			if (tokens[0].substr(1) == schrom) chr_found = true;
+		} else if (chr_found) refseq.append(buffer.data(), buffer.size());
 	}
 	fd.close();
 	vrb.bullet("L=" + stb.str(refseq.size()));
@@ -32,14 +32,17 @@ void lifter::declare_options() {
 
 	bpo::options_description opt_input ("Input files");
 	opt_input.add_options()
-			("input", bpo::value< string >(), "Input genotypes in VCF/BCF format")
+			("input", bpo::value< string >(), "Input genotypes in VCF/BCF format, - for stdin")
 			("chain", bpo::value< string >(), "Chain file")
 			("chr", bpo::value< string >(), "Chromosome")
 			("fasta", bpo::value< string >(), "Target reference genome (fasta) for allele matching");
 
 	bpo::options_description opt_output ("Output files");
 	opt_output.add_options()
-			("output", bpo::value< string >(), "Output genotypes in VCF/BCF format")
+			("output", bpo::value< string >(), "Output genotypes in VCF/BCF format, - for stdout")
+			("output-type", bpo::value< string >(), "Output type: v (VCF), z (compressed VCF), u (uncompressed BCF) or b (compressed BCF); from the file extension by default")
+			("compression-level", bpo::value< int >(), "Compression level of the outputs, from 0 (fastest) to 9 (smallest); htslib default otherwise")
+			("write-index", "Index the compressed output (CSI) while writing it")
 			("log", bpo::value< string >(), "Log file");
 
 	descriptions.add(opt_base).add(opt_input).add(opt_output);
@@ -53,6 +56,9 @@ void lifter::parse_command_line(vector < string > & args) {
 
 	if (options.count("help")) { cout << descriptions << endl; exit(0); }
 
+	//Records go to stdout: keep it clean of messages
+	if (options.count("output") && options["output"].as < string > () == "-") vrb.set_stderr();
+
 	if (options.count("log") && !vrb.open_log(options["log"].as < string > ()))
 		vrb.error("Impossible to create log file [" + options["log"].as < string > () +"]");
 
@@ -85,8 +91,11 @@ void lifter::verbose_files() {
 	vrb.bullet("Input VCF     : [" + options["input"].as < string > () + "]");
 	vrb.bullet("UCSC chain    : [" + options["chain"].as < string > () + "]");
 	vrb.bullet("Output VCF    : [" + options["output"].as < string > () + "]");
+	if (options.count("output-type")) vrb.bullet("Output type   : [" + options["output-type"].as < string > () + "]");
+	if (options.count("write-index")) vrb.bullet("Output index  : [" + options["output"].as < string > () + ".csi]");
 }
 
 void lifter::verbose_options() {
 	vrb.title("Parameters:");
+	if (options.count("compression-level")) vrb.bullet("Compression   : [level " + stb.str(options["compression-level"].as < int > ()) + " / " + vcf_output_file::backend() + "]");
 }
@@ -26,10 +26,6 @@
 using namespace liftover;
 using namespace std;
 
-#define OFILE_VCFU	0
-#define OFILE_VCFC	1
-#define OFILE_BCFC	2
-
 void lifter::lift() {
 	tac.clock();
 	string finput = options["input"].as < string > ();
@@ -43,9 +39,9 @@ void lifter::lift() {
 
 	vrb.title("Reading data in [" + finput + "]");
 
-	//Opening input file
+	//Opening input file; one I/O thread pool is shared by the input and the output
+	io_pool iop(options["thread"].as < int > ());
 	bcf_srs_t * sr =  bcf_sr_init();
-	if (options["thread"].as < int > () > 1) bcf_sr_set_threads(sr, options["thread"].as < int > ());
     if (!(bcf_sr_add_reader (sr, finput.c_str()))) {
     	switch (sr->errnum) {
 		case not_bgzf: vrb.error("File not compressed with bgzip!"); break;
@@ -54,46 +50,50 @@ void lifter::lift() {
 		default : vrb.error("Unknown error!");
 		}
 	}
+	if (!iop.attach(sr)) vrb.error("Impossible to attach threads to [" + finput + "]");
     int nsamples = bcf_hdr_nsamples(sr->readers[0].header);
     vrb.bullet("#samples = " + stb.str(nsamples));
 
-	//Opening input file
-    string file_format = "w";
-	unsigned int file_type = OFILE_VCFU;
-	if (foutput.size() > 6 && foutput.substr(foutput.size()-6) == "vcf.gz") { file_format = "wz"; file_type = OFILE_VCFC; }
-	if (foutput.size() > 3 && foutput.substr(foutput.size()-3) == "bcf") { file_format = "wb"; file_type = OFILE_BCFC; }
-	htsFile * fp = hts_open(foutput.c_str(),file_format.c_str());
-	if (options["thread"].as < int > () > 1) hts_set_threads(fp, options["thread"].as < int > ());
 	bcf_hdr_t * hdr = sr->readers[0].header;
 
-	if (bcf_hdr_write(fp, hdr) < 0) vrb.error("Failing to write VCF/header in [" + foutput + "]");
-
-    // Declare arrays for data
-    int ngt, ngt_arr = 0; int * gt_arr = NULL;		//Genotype
+	//Opening output file
+	vcf_output_file out;
+	string otype = options.count("output-type") ? options["output-type"].as < string > () : "";
+	int level = options.count("compression-level") ? options["compression-level"].as < int > () : -1;
+	if (!out.open(foutput, hdr, &iop, options.count("write-index") > 0, otype, level)) vrb.error(out.error);
 
-    //Read data
+    //Read data; the chain target is looked up once per contig and the matches vector is reused
 	bcf1_t * line_data;
+	Target * target = NULL;
+	int target_rid = -1;
+	vector < Match > matches;
+	heap_meter meter;
 	int n_parsed = 0, n_success = 0, n_nfound = 0, n_mfound = 0, n_negstrand = 0, n_refallele = 0, n_diffchr = 0;
 	while(bcf_sr_next_line (sr)) {
 
 		line_data =  bcf_sr_get_line(sr, 0);
+		meter.step();
 
-		bcf_unpack(line_data, BCF_UN_STR);
-		string chr = bcf_hdr_id2name(hdr, line_data->rid);
+		string_view chr = record_contig(hdr, line_data);
 		int pos = line_data->pos;
-		string ref = string(line_data->d.allele[0]);
+		string_view ref = record_allele(line_data, 0);
 
-		vector< Match > matches = targets[chr][pos];
+		if (line_data->rid != target_rid) {
+			map < string, Target > :: iterator it = targets.find(string(chr));
+			target = (it != targets.end()) ? &it->second : NULL;
+			target_rid = line_data->rid;
+		}
+		matches.clear();
+		if (target) target->query(pos, matches);
 
 		if (matches.size() == 1) {
 			if (matches[0].contig == chr) {
 				if (matches[0].fwd_strand) {
 					int new_pos0 = matches[0].pos;
 					assert(new_pos0 + ref.size() <= refseq.size());
-					string new_refA = refseq.substr(new_pos0, ref.size());
-					if (new_refA == ref) {
+					if (refseq.compare(new_pos0, ref.size(), ref) == 0) {
 						line_data->pos = new_pos0;
-						if (bcf_write1(fp, hdr, line_data) < 0) vrb.error("Failing to write VCF/record");
+						if (!out.write(hdr, line_data)) vrb.error(out.indexed ? "Failing to write VCF/record, lifted-over records must be sorted to be indexed" : "Failing to write VCF/record");
 						n_success++;
 					} else n_refallele++;
 				} else n_negstrand++;
@@ -102,17 +102,13 @@ void lifter::lift() {
 		else n_mfound++;
 		n_parsed++;
 	}
-	free(gt_arr);
-	bcf_destroy1(line_data);
-	bcf_hdr_destroy(hdr);
-	if (hts_close(fp)) vrb.error("Non zero status when closing VCF/BCF file descriptor");
+	meter.stop();
+	if (!out.close()) vrb.error("Non zero status when closing VCF/BCF file descriptor or saving its index");
+	bcf_sr_destroy(sr);
 
 	vrb.title("Writing lifted-over data in [" + foutput + "]");
-	switch (file_type) {
-	case OFILE_VCFU: vrb.bullet("VCF uncompressed / N=" + stb.str(nsamples) + " (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_VCFC: vrb.bullet("VCF compressed / N=" + stb.str(nsamples) + " (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	case OFILE_BCFC: vrb.bullet("BCF compressed / N=" + stb.str(nsamples) + " (" + stb.str(tac.rel_time()*0.001, 2) + "s)"); break;
-	}
+	vrb.bullet(out.format() + " " + out.compression() + " / N=" + stb.str(nsamples) + " (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+	if (out.indexed) vrb.bullet("Index written in [" + out.fnidx + "]");
 	vrb.bullet("#records parsed = " + stb.str(n_parsed));
 	vrb.bullet("#records successfully lifted-over = " + stb.str(n_success));
 	vrb.bullet("#records NOT lifted-over = " + stb.str(n_nfound+n_mfound+n_negstrand+n_refallele+n_diffchr));
@@ -121,6 +117,7 @@ void lifter::lift() {
 	vrb.bullet("   - negative strand = " + stb.str(n_negstrand));
 	vrb.bullet("   - unmatching REF allele = " + stb.str(n_refallele));
 	vrb.bullet("   - different contig = " + stb.str(n_diffchr));
+	if (meter.enabled()) vrb.bullet("#heap allocations in steady state = " + meter.str());
 
 	//step2: Measure overall running time
 	vrb.title("Total running time = " + stb.str(tac.abs_time()) + " seconds");
@@ -0,0 +1 @@
+../../../common/src/utils/heap_counter.h
\ No newline at end of file
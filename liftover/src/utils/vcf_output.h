@@ -0,0 +1 @@
+../../../common/src/utils/vcf_output.h
\ No newline at end of file
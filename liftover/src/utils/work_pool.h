@@ -0,0 +1 @@
+../../../common/src/utils/work_pool.h
\ No newline at end of file
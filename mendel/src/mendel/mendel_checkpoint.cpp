@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * Copyright (C) 2020 Olivier Delaneau, University of Lausanne
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+#include <mendel/mendel_header.h>
+
+using namespace std;
+
+#define CHECKPOINT_MAGIC "MENDEL_CHECKPOINT_V1"
+
+static void write_string(ofstream & fd, const string & s) {
+	uint64_t n = s.size();
+	fd.write((char*)&n, sizeof(uint64_t));
+	fd.write(s.c_str(), n);
+}
+
+static void write_vector(ofstream & fd, const vector < int > & v) {
+	uint64_t n = v.size();
+	fd.write((char*)&n, sizeof(uint64_t));
+	fd.write((char*)v.data(), n * sizeof(int));
+}
+
+static bool read_string(ifstream & fd, string & s) {
+	uint64_t n = 0;
+	if (!fd.read((char*)&n, sizeof(uint64_t))) return false;
+	s.resize(n);
+	return (bool)fd.read(&s[0], n);
+}
+
+//Checkpointed vectors must match the ones allocated by the current run
+static bool read_vector(ifstream & fd, vector < int > & v) {
+	uint64_t n = 0;
+	if (!fd.read((char*)&n, sizeof(uint64_t)) || n != v.size()) return false;
+	return (bool)fd.read((char*)v.data(), n * sizeof(int));
+}
+
+void mendel::writeCheckpoint(string fckpt, bgzf_output_file & fdv) {
+	//Reports are flushed first so that the saved offsets point to complete BGZF blocks on disk
+	ckpt_var_offset = fdv.flush();
+	ckpt_win_offset = fdw ? fdw->flush() : -1;
+	if (ckpt_var_offset < 0 || (fdw && ckpt_win_offset < 0)) vrb.error("Failed to flush reports for checkpointing");
+
+	string ftmp = fckpt + ".tmp";
+	ofstream fd(ftmp, ios::out | ios::binary | ios::trunc);
+	write_string(fd, CHECKPOINT_MAGIC);
+	write_string(fd, options["input"].as < string > ());
+	write_string(fd, ckpt_chr);
+	fd.write((char*)&ckpt_pos, sizeof(int));
+	fd.write((char*)&ckpt_ties, sizeof(int));
+	fd.write((char*)&ckpt_line, sizeof(int));
+	fd.write((char*)&ckpt_var_offset, sizeof(int64_t));
+	fd.write((char*)&ckpt_win_offset, sizeof(int64_t));
+	write_vector(fd, mendel_errors);
+	write_vector(fd, mendel_totals);
+	write_string(fd, window_chr);
+	fd.write((char*)&window_start, sizeof(int));
+	fd.write((char*)&window_end, sizeof(int));
+	fd.write((char*)&window_nvar, sizeof(int));
+	write_vector(fd, window_errors);
+	write_vector(fd, window_totals);
+	write_vector(fd, summary_errors);
+	write_vector(fd, summary_totals);
+	fd.close();
+	if (fd.fail()) vrb.error("Failed to write checkpoint [" + ftmp + "]");
+
+	//Atomic replacement of the previous checkpoint
+	if (rename(ftmp.c_str(), fckpt.c_str())) vrb.error("Failed to rename checkpoint [" + ftmp + "]");
+	vrb.bullet("Checkpoint at [" + ckpt_chr + ":" + stb.str(ckpt_pos) + "] after " + stb.str(ckpt_line) + " records");
+}
+
+void mendel::readCheckpoint(string fckpt, bool counters) {
+	ifstream fd(fckpt, ios::in | ios::binary);
+	if (fd.fail()) vrb.error("Cannot open checkpoint [" + fckpt + "]");
+	string magic, finput;
+	bool ok = read_string(fd, magic) && (magic == CHECKPOINT_MAGIC);
+	ok = ok && read_string(fd, finput) && read_string(fd, ckpt_chr);
+	ok = ok && fd.read((char*)&ckpt_pos, sizeof(int)) && fd.read((char*)&ckpt_ties, sizeof(int)) && fd.read((char*)&ckpt_line, sizeof(int));
+	ok = ok && fd.read((char*)&ckpt_var_offset, sizeof(int64_t)) && fd.read((char*)&ckpt_win_offset, sizeof(int64_t));
+	if (!ok) vrb.error("Checkpoint [" + fckpt + "] is corrupted");
+	if (finput != options["input"].as < string > ()) vrb.error("Checkpoint [" + fckpt + "] was created from another input [" + finput + "]");
+	if (!counters) return;
+
+	ok = read_vector(fd, mendel_errors) && read_vector(fd, mendel_totals);
+	ok = ok && read_string(fd, window_chr) && fd.read((char*)&window_start, sizeof(int)) && fd.read((char*)&window_end, sizeof(int)) && fd.read((char*)&window_nvar, sizeof(int));
+	ok = ok && read_vector(fd, window_errors) && read_vector(fd, window_totals);
+	ok = ok && read_vector(fd, summary_errors) && read_vector(fd, summary_totals);
+	if (!ok) vrb.error("Checkpoint [" + fckpt + "] does not match the samples, pedigree or options of this run");
+	vrb.bullet("Resuming after [" + ckpt_chr + ":" + stb.str(ckpt_pos) + "] and " + stb.str(ckpt_line) + " records");
+}
@@ -32,9 +32,10 @@ public:
 	bpo::variables_map options;
 
 	//FAM DATA
-	std::vector < std::string > kids;
-	std::vector < std::string > fathers;
-	std::vector < std::string > mothers;
+	sample_index pedigree;						//names found in the pedigree
+	std::vector < int > kids;					//families, as ids in pedigree
+	std::vector < int > fathers;
+	std::vector < int > mothers;
 
 	//SAMPLE DATA
 	std::vector < std::string > samples;
@@ -43,6 +44,36 @@ public:
 	std::vector < int > mendel_errors;
 	std::vector < int > mendel_totals;
 
+	//TRIO INDEX
+	std::vector < int > trios;						//Flattened (kid, father, mother) triples; -1 for the missing parent of a duo
+	std::vector < unsigned char > dosages;			//Per sample ALT dosage of the current variant; 3 when missing
+	unsigned char error_table [64];					//Mendel error, indexed by father*16 + mother*4 + kid dosages
+	unsigned char total_table [2][64];				//Informative trio/duo, indexed by [major][father*16 + mother*4 + kid]
+
+	//WINDOWED ERROR TRACKS
+	int window_bp, window_var;						//Window size in bp or in variants; 0 when unused
+	std::string window_chr;
+	int window_start, window_end, window_nvar;
+	std::vector < int > window_errors;				//Per trio/duo counters over the current window
+	std::vector < int > window_totals;
+	bgzf_output_file * fdw;
+
+	//MAF BINNED SUMMARY
+	std::vector < float > maf_bins;					//Upper bounds of the MAF bins
+	std::vector < std::string > classes;			//Variant classes the summary is split by
+	std::vector < int > summary_errors;				//Counters indexed by [class][bin][trio]
+	std::vector < int > summary_totals;
+
+	//I/O THREADS
+	io_pool * iop;									//Shared by the input and all the compressed outputs
+	int compression_level;							//BGZF level of the reports; -1 for the default
+
+	//CHECKPOINTING
+	int checkpoint_every;							//Number of records between checkpoints; 0 when disabled
+	std::string ckpt_chr;							//Last processed record and the number of records read at its position
+	int ckpt_pos, ckpt_ties, ckpt_line;
+	int64_t ckpt_var_offset, ckpt_win_offset;		//Resume points in the partial reports
+
 	//CONSTRUCTOR
 	mendel();
 	~mendel();
@@ -57,7 +88,19 @@ public:
 
 	//
 	void readPedigree(std::string fped);
-	void checkMendel(int * genotypes, float & maf, int & m_errors, int & m_totals);
+	void buildMendelTables();
+	void buildTrioIndex();
+	void checkMendel(int * genotypes, int vclass, float & maf, int & m_errors, int & m_totals);
+	void initSummary();
+	int getClass(bcf1_t * rec);
+	void writeSummary(std::string fsum);
+	void writeCheckpoint(std::string fckpt, bgzf_output_file & fdv);
+	void readCheckpoint(std::string fckpt, bool counters);
+	void initWindows();
+	void openWindows(std::string fwin);
+	void updateWindow(const std::string & chr, int pos);
+	void writeWindow();
+	void closeWindows();
 	void check();
 	void check(std::vector < std::string > & args);
 };
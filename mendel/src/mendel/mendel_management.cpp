@@ -24,6 +24,14 @@
 using namespace std;
 
 mendel::mendel() {
+	window_bp = window_var = 0;
+	fdw = NULL;
+	iop = NULL;
+	compression_level = -1;
+	checkpoint_every = 0;
+	ckpt_pos = ckpt_ties = ckpt_line = 0;
+	ckpt_var_offset = ckpt_win_offset = -1;
+	buildMendelTables();
 }
 
 mendel::~mendel() {
@@ -39,6 +39,13 @@ void mendel::declare_options() {
 	bpo::options_description opt_output ("Output files");
 	opt_output.add_options()
 			("output", bpo::value< string >(), "Prefix for the Mendel reports")
+			("window-bp", bpo::value< int >(), "Also write per trio error rates in windows of this many bp [prefix.win.txt.gz]")
+			("window-variants", bpo::value< int >(), "Also write per trio error rates in windows of this many variants [prefix.win.txt.gz]")
+			("maf-bins", bpo::value< string >(), "Also write per trio error counts in these comma separated MAF bin upper bounds [prefix.maf.txt.gz], e.g. 0.01,0.05,0.1; a last bin up to 0.5 is implied")
+			("by-class", "Split the MAF binned counts by variant class (SNP/INDEL/OTHER)")
+			("compression-level", bpo::value< int >(), "Compression level of the outputs, from 0 (fastest) to 9 (smallest); htslib default otherwise")
+			("checkpoint", bpo::value< int >(), "Save a checkpoint every this many VCF records [prefix.ckpt]")
+			("resume", "Resume an interrupted run from its last checkpoint [prefix.ckpt]")
 			("log", bpo::value< string >(), "Log file");
 
 	descriptions.add(opt_base).add(opt_input).add(opt_output);
@@ -74,6 +81,24 @@ void mendel::check_options() {
 
 	if (!options.count("region"))
 		vrb.error("You must specify --region");
+
+	if (options.count("window-bp") && options.count("window-variants"))
+		vrb.error("--window-bp and --window-variants are mutually exclusive");
+
+	if (options.count("window-bp") && options["window-bp"].as < int > () <= 0)
+		vrb.error("--window-bp must be a positive number of bp");
+
+	if (options.count("window-variants") && options["window-variants"].as < int > () <= 0)
+		vrb.error("--window-variants must be a positive number of variants");
+
+	if (options.count("by-class") && !options.count("maf-bins"))
+		vrb.error("--by-class requires --maf-bins");
+
+	if (options.count("checkpoint") && options["checkpoint"].as < int > () <= 0)
+		vrb.error("--checkpoint must be a positive number of records");
+
+	if (options.count("resume") && options["region"].as < string > ().find(',') != string::npos)
+		vrb.error("--resume requires a single region");
 }
 
 void mendel::verbose_files() {
@@ -85,5 +110,11 @@ void mendel::verbose_files() {
 
 void mendel::verbose_options() {
 	vrb.title("Parameters:");
+	if (options.count("compression-level")) vrb.bullet("Compression   : [level " + stb.str(options["compression-level"].as < int > ()) + " / " + vcf_output_file::backend() + "]");
 	vrb.bullet("Region        : [" + options["region"].as < string > () + "]");
+	if (options.count("window-bp")) vrb.bullet("Windows       : [" + stb.str(options["window-bp"].as < int > ()) + " bp]");
+	if (options.count("window-variants")) vrb.bullet("Windows       : [" + stb.str(options["window-variants"].as < int > ()) + " variants]");
+	if (options.count("checkpoint")) vrb.bullet("Checkpoints   : [every " + stb.str(options["checkpoint"].as < int > ()) + " records]");
+	if (options.count("resume")) vrb.bullet("Resume        : [from " + options["output"].as < string > () + ".ckpt]");
+	if (options.count("maf-bins")) vrb.bullet("MAF bins      : [" + options["maf-bins"].as < string > () + "]" + (options.count("by-class")?" by variant class":""));
 }
@@ -26,52 +26,29 @@ using namespace std;
 
 void mendel::readPedigree(string fped) {
 	vrb.title("Reading pedigree in [" + fped + "]");
-	string buffer;
-	vector < string > tokens;
-	input_file fd_ped(fped);
+	string_view buffer;
+	vector < string_view > tokens;
+	bgzf_input_file fd_ped(fped);
 	if (fd_ped.fail()) vrb.error("Cannot open PED file");
-	while (getline(fd_ped, buffer)) {
-		stb.split(buffer, tokens);
+	while (fd_ped.getline(buffer)) {
+		if (stb.tokenize(buffer, tokens) == 0) continue;
 		if (tokens.size() < 3) vrb.error("Problem in pedigree file; each line should have 3 columns at least");
-		kids.push_back(tokens[0]);
-		fathers.push_back(tokens[1]);
-		mothers.push_back(tokens[2]);
+		kids.push_back(pedigree.insert(tokens[0]));
+		fathers.push_back(pedigree.insert(tokens[1]));
+		mothers.push_back(pedigree.insert(tokens[2]));
 	}
 	fd_ped.close();
 	vrb.bullet("#families = " + stb.str(kids.size()));
 }
 
-void mendel::checkMendel(int * genotypes, float & maf, int & m_errors, int & m_totals) {
-
-	//Get Major
-	unsigned int nAC = 0, nAN = 0;
-	for (int kidx = 0 ; kidx < samples.size() ; kidx++) {
-		if (genotypes[2*kidx+0] != bcf_gt_missing && genotypes[2*kidx+1] != bcf_gt_missing) {
-			nAC += (bcf_gt_allele(genotypes[2*kidx+0])==1) + (bcf_gt_allele(genotypes[2*kidx+1])==1);
-			nAN += 2;
-		}
-	}
-	maf = nAC * 1.0f / nAN;
-	bool major = (maf > 0.5f);
-
-	//Check Mendel
-	m_errors = m_totals = 0;
-	for (int kidx = 0 ; kidx < samples.size() ; kidx++) {
-
-		int kg = -1;
-		if (genotypes[2*kidx+0] != bcf_gt_missing && genotypes[2*kidx+1] != bcf_gt_missing)
-			kg = (bcf_gt_allele(genotypes[2*kidx+0])==1) + (bcf_gt_allele(genotypes[2*kidx+1])==1);
-
-		int fg = -1;
-		if ((fathers_idx[kidx]>=0) && (genotypes[2*fathers_idx[kidx]+0] != bcf_gt_missing) && (genotypes[2*fathers_idx[kidx]+1] != bcf_gt_missing))
-			fg = (bcf_gt_allele(genotypes[2*fathers_idx[kidx]+0])==1) + (bcf_gt_allele(genotypes[2*fathers_idx[kidx]+1])==1);
-
-		int mg = -1;
-		if ((mothers_idx[kidx]>=0) && (genotypes[2*mothers_idx[kidx]+0] != bcf_gt_missing) && (genotypes[2*mothers_idx[kidx]+1] != bcf_gt_missing))
-			mg = (bcf_gt_allele(genotypes[2*mothers_idx[kidx]+0])==1) + (bcf_gt_allele(genotypes[2*mothers_idx[kidx]+1])==1) ;
+void mendel::buildMendelTables() {
+	//Dosage code 3 stands for a missing genotype or an absent parent
+	for (int fg = 0 ; fg < 4 ; fg ++) for (int mg = 0 ; mg < 4 ; mg ++) for (int kg = 0 ; kg < 4 ; kg ++) {
+		bool fo = (fg < 3), mo = (mg < 3), ko = (kg < 3);
+		int code = fg * 16 + mg * 4 + kg;
 
 		int error = 0;
-		if (kg>=0 && fg>=0 && mg>=0) {
+		if (ko && fo && mo) {
 			if (fg == 0 && mg == 0 && kg == 1) { error = 1;}
 			if (fg == 0 && mg == 0 && kg == 2) { error = 1;}
 			if (fg == 0 && mg == 1 && kg == 2) { error = 1;}
@@ -85,39 +62,103 @@ void mendel::checkMendel(int * genotypes, float & maf, int & m_errors, int & m_t
 			if (fg == 2 && mg == 2 && kg == 0) { error = 1;}
 			if (fg == 2 && mg == 2 && kg == 1) { error = 1;}
 		}
-		if (kg>=0 && fg>=0 && mg<0) {
+		if (ko && fo && !mo) {
 			if (fg == 0 && kg == 2) { error = 1;}
 			if (fg == 2 && kg == 0) { error = 1;}
 		}
-		if (kg>=0 && fg<0 && mg>=0) {
+		if (ko && !fo && mo) {
 			if (mg == 0 && kg == 2) { error = 1;}
 			if (mg == 2 && kg == 0) { error = 1;}
 		}
+		error_table[code] = error;
 
-		int total = 0;
-		if (kg>=0 && fg>=0 && mg>=0) {
-			//total = (!major && kg!=0 && fg!=0 && mg!=0) || (major && kg!=2 && fg!=2 && mg!=2);
-			if (major) total = (kg!=2) || (fg!=2) || (mg!=2);
-			else total = (kg!=0) || (fg!=0) || (mg!=0);
-		}
-		if (kg>=0 && fg>=0 && mg<0) {
-			//total = (!major && kg!=0 && fg!=0) || (major && kg!=2 && fg!=2);
-			if (major) total = (kg!=2) || (fg!=2);
-			else total = (kg!=0) || (fg!=0);
-		}
-		if (kg>=0 && fg<0 && mg>=0) {
-			//total = (!major && kg!=0 && mg!=0) || (major && kg!=2 && mg!=2);
-			if (major) total = (kg!=2) || (mg!=2);
-			else total = (kg!=0) || (mg!=0);
+		//Only count trios/duos that are not homozygous for the major allele
+		for (int major = 0 ; major < 2 ; major ++) {
+			int total = 0;
+			if (ko && fo && mo) {
+				if (major) total = (kg!=2) || (fg!=2) || (mg!=2);
+				else total = (kg!=0) || (fg!=0) || (mg!=0);
+			}
+			if (ko && fo && !mo) {
+				if (major) total = (kg!=2) || (fg!=2);
+				else total = (kg!=0) || (fg!=0);
+			}
+			if (ko && !fo && mo) {
+				if (major) total = (kg!=2) || (mg!=2);
+				else total = (kg!=0) || (mg!=0);
+			}
+			total_table[major][code] = total;
 		}
+	}
+}
 
-		if (error > total) {
-			cout << endl << "DIOGO's VERBOSE kidx=" << kidx << " af=" << maf << " nAC=" << nAC << " nAN=" << nAN << " major=" << major << " kg=" << kg << " fg=" << fg << " mg=" << mg << " error=" << error << " total=" << total << endl;
-		}
+void mendel::buildTrioIndex() {
+	//Dense list of trios and duos, in increasing kid order, so that the check loop never visits unrelated samples
+	trios.clear();
+	for (int kidx = 0 ; kidx < samples.size() ; kidx++) {
+		if (fathers_idx[kidx] < 0 && mothers_idx[kidx] < 0) continue;
+		trios.push_back(kidx);
+		trios.push_back(fathers_idx[kidx]);
+		trios.push_back(mothers_idx[kidx]);
+	}
+	dosages = std::vector < unsigned char > (samples.size() + 1, 3);
+	vrb.bullet("#samples with at least one parent = " + stb.str(trios.size() / 3));
+}
+
+void mendel::checkMendel(int * genotypes, int vclass, float & maf, int & m_errors, int & m_totals) {
+	unsigned int nsamples = samples.size();
+	unsigned char * dos = dosages.data();
+
+	//Decode dosages and count alleles; branchless so that the compiler vectorizes it
+	unsigned int nAC = 0, nAN = 0;
+	for (unsigned int i = 0 ; i < nsamples ; i++) {
+		int a0 = genotypes[2*i+0], a1 = genotypes[2*i+1];
+		unsigned int obs = (a0 != bcf_gt_missing) & (a1 != bcf_gt_missing);
+		unsigned int dos_i = (bcf_gt_allele(a0)==1) + (bcf_gt_allele(a1)==1);
+		dos[i] = obs ? dos_i : 3;
+		nAC += obs ? dos_i : 0;
+		nAN += obs * 2;
+	}
+	maf = nAN ? (nAC * 1.0f / nAN) : 0.0f;
+	const unsigned char * total_major = total_table[maf > 0.5f];
 
+	//Check Mendel over trios and duos only; missing parents point to the sentinel dosage at index nsamples
+	m_errors = m_totals = 0;
+	const int * trio = trios.data();
+	unsigned int ntrios = trios.size() / 3;
+	int * werrors = fdw ? window_errors.data() : NULL;
+	int * wtotals = fdw ? window_totals.data() : NULL;
+	int * serrors = NULL, * stotals = NULL;
+	//The last bin ends at 0.5 at least, so that every minor allele frequency has its bin
+	if (!maf_bins.empty() && nAN) {
+		float minor = std::min(maf, 1.0f - maf);
+		int bin = 0;
+		while (bin < maf_bins.size() - 1 && minor > maf_bins[bin]) bin ++;
+		serrors = summary_errors.data() + (vclass * maf_bins.size() + bin) * ntrios;
+		stotals = summary_totals.data() + (vclass * maf_bins.size() + bin) * ntrios;
+	}
+	for (unsigned int t = 0 ; t < ntrios ; t++, trio += 3) {
+		if (t + 8 < ntrios) {
+			__builtin_prefetch(dos + (trio[25] < 0 ? nsamples : trio[25]));
+			__builtin_prefetch(dos + (trio[26] < 0 ? nsamples : trio[26]));
+		}
+		int kidx = trio[0];
+		unsigned int fg = dos[(trio[1] < 0) ? nsamples : trio[1]];
+		unsigned int mg = dos[(trio[2] < 0) ? nsamples : trio[2]];
+		unsigned int code = fg * 16 + mg * 4 + dos[kidx];
+		int error = error_table[code];
+		int total = total_major[code];
 		mendel_errors[kidx] += error;
 		mendel_totals[kidx] += total;
 		m_errors += error;
 		m_totals += total;
+		if (werrors) {
+			werrors[t] += error;
+			wtotals[t] += total;
+		}
+		if (serrors) {
+			serrors[t] += error;
+			stotals[t] += total;
+		}
 	}
 }
@@ -34,11 +34,23 @@ void mendel::check() {
 	string finput = options["input"].as < string > ();
 	string foutput = options["output"].as < string > ();
 	string region = options["region"].as < string > ();
+	string fckpt = foutput + ".ckpt";
 	vrb.title("Reading data in [" + finput + "]");
 
-	//Opening input file
+	//Resuming: restart the region at the last checkpointed position
+	if (options.count("resume")) {
+		readCheckpoint(fckpt, false);
+		hts_pos_t rbeg, rend;
+		const char * rchr = hts_parse_reg64(region.c_str(), &rbeg, &rend);
+		if (!rchr || string(region.c_str(), rchr) != ckpt_chr) vrb.error("Checkpoint [" + fckpt + "] is not on region [" + region + "]");
+		region = ckpt_chr + ":" + stb.str(ckpt_pos) + "-" + ((rend < HTS_POS_MAX)?stb.str(rend):"");
+		vrb.bullet("Resumed region = [" + region + "]");
+	}
+
+	//Opening input file; one I/O thread pool is shared by the input and the outputs
+	iop = new io_pool(options["thread"].as < int > ());
+	if (options.count("compression-level")) compression_level = options["compression-level"].as < int > ();
 	bcf_srs_t * sr =  bcf_sr_init();
-	if (options["thread"].as < int > () > 1) bcf_sr_set_threads(sr, options["thread"].as < int > ());
 	if (bcf_sr_set_regions(sr, region.c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + region + "]");
 	if (!(bcf_sr_add_reader (sr, finput.c_str()))) {
     	switch (sr->errnum) {
@@ -48,6 +60,7 @@ void mendel::check() {
 		default : vrb.error("Unknown error!");
 		}
 	}
+	if (!iop->attach(sr)) vrb.error("Impossible to attach threads to [" + finput + "]");
 
     //Sample IDs
     int nsamples = bcf_hdr_nsamples(sr->readers[0].header);
@@ -57,68 +70,129 @@ void mendel::check() {
     mendel_errors = vector < int > (nsamples, 0);
 	mendel_totals = vector < int > (nsamples, 0);
 
-    map < std::string , int > mapF2S;
+    //Pedigree ids to sample indexes, one hash lookup per sample; the first of duplicated samples is kept
+    vector < int > ped2vcf (pedigree.size(), -1);
+    samples.reserve(nsamples);
     for (int i = 0 ; i < nsamples ; i ++) {
     	samples.push_back(std::string(sr->readers[0].header->samples[i]));
-    	mapF2S.insert(pair < std::string, int > (samples.back(), i));
+    	int p = pedigree.find(samples.back());
+    	if (p >= 0 && ped2vcf[p] < 0) ped2vcf[p] = i;
     }
     unsigned int ntrios = 0, nduosF = 0, nduosM = 0;
     for (int f = 0 ; f < kids.size() ; f ++) {
-    	map < std::string , int > ::iterator itK = mapF2S.find(kids[f]);
-    	map < std::string , int > ::iterator itF = mapF2S.find(fathers[f]);
-    	map < std::string , int > ::iterator itM = mapF2S.find(mothers[f]);
+    	int k = ped2vcf[kids[f]], fa = ped2vcf[fathers[f]], mo = ped2vcf[mothers[f]];
 
-    	if (itK != mapF2S.end() && itF != mapF2S.end() && itM != mapF2S.end()) {
-    		fathers_idx[itK->second] = itF->second;
-    		mothers_idx[itK->second] = itM->second;
+    	if (k >= 0 && fa >= 0 && mo >= 0) {
+    		fathers_idx[k] = fa;
+    		mothers_idx[k] = mo;
     		ntrios++;
     	}
 
-    	if (itK != mapF2S.end() && itF != mapF2S.end() && itM == mapF2S.end()) {
-    		fathers_idx[itK->second] = itF->second;
+    	if (k >= 0 && fa >= 0 && mo < 0) {
+    		fathers_idx[k] = fa;
     		nduosF++;
     	}
 
-    	if (itK != mapF2S.end() && itF == mapF2S.end() && itM != mapF2S.end()) {
-    		mothers_idx[itK->second] = itM->second;
+    	if (k >= 0 && fa < 0 && mo >= 0) {
+    		mothers_idx[k] = mo;
     		nduosM++;
     	}
     }
     vrb.bullet("#trios = " + stb.str(ntrios) + " | #duos_paternal = " + stb.str(nduosF) + " | #duos_maternal = " + stb.str(nduosM));
+    buildTrioIndex();
+    initWindows();
+    initSummary();
+    if (options.count("resume")) readCheckpoint(fckpt, true);
+    openWindows(foutput + ".win.txt.gz");
 
     //Read data and output to file
-    output_file fdv(foutput + ".var.txt.gz");
-    int ngt, ngt_arr = 0; int * gt_arr = NULL, line = 0;
+    bgzf_output_file fdv(foutput + ".var.txt.gz", 1, 2, 2, iop->size(), compression_level, ckpt_var_offset, iop->get());
+    if (fdv.fail()) vrb.error(fdv.error);
+    string record, chr;
+    heap_meter meter;
+    int ngt, ngt_arr = 0; int * gt_arr = NULL, line = ckpt_line;
+    int skip_ties = ckpt_ties, last_rid = -1, last_pos = ckpt_pos, last_ties = ckpt_ties;
+    bool resuming = options.count("resume") > 0;
+    if (options.count("checkpoint")) checkpoint_every = options["checkpoint"].as < int > ();
+    if (resuming) last_rid = bcf_hdr_name2id(sr->readers[0].header, ckpt_chr.c_str());
     bcf1_t * line_data;
 	while(bcf_sr_next_line (sr)) {
 		line_data =  bcf_sr_get_line(sr, 0);
-		if (line_data && line_data->n_allele == 2) {
-			std::string chr = bcf_hdr_id2name(sr->readers[0].header, line_data->rid);
+		if (!line_data) continue;
+		meter.step();
+
+		//Skip the records already processed before the checkpoint
+		if (resuming) {
+			if (line_data->pos + 1 < ckpt_pos) continue;
+			if (line_data->pos + 1 == ckpt_pos && skip_ties > 0) { skip_ties--; continue; }
+			resuming = false;
+		}
+
+		//Records sharing a position are counted to resume in the middle of them
+		if (line_data->rid == last_rid && line_data->pos + 1 == last_pos) last_ties++;
+		else { last_rid = line_data->rid; last_pos = line_data->pos + 1; last_ties = 1; }
+
+		if (line_data->n_allele == 2) {
 			int pos = line_data->pos + 1;
-			std::string id = std::string(line_data->d.id);
-			std::string ref = std::string(line_data->d.allele[0]);
-			std::string alt = std::string(line_data->d.allele[1]);
 			ngt = bcf_get_genotypes(sr->readers[0].header, line_data, &gt_arr, &ngt_arr);
 			assert(ngt == 2 * nsamples);
+			chr.assign(record_contig(sr->readers[0].header, line_data));
+			if (fdw) updateWindow(chr, pos);
 			float maf;
 			int v_errors = 0, v_totals = 0;
-			checkMendel(gt_arr, maf, v_errors, v_totals);
-			fdv << chr << "\t" << pos << "\t" << ref << "\t" << alt << "\t" << maf << "\t" << v_errors << "\t" << v_totals << "\t" << stb.str(v_totals?(v_errors*100.0f/v_totals):0, 2) << endl;
+			checkMendel(gt_arr, getClass(line_data), maf, v_errors, v_totals);
+			if (fdw && window_var && window_nvar == window_var) writeWindow();
+
+			//Format the record in a reusable buffer
+			record.clear();
+			record += chr; record += '\t';
+			stb.append(record, pos); record += '\t';
+			record += line_data->d.allele[0]; record += '\t';
+			record += line_data->d.allele[1]; record += '\t';
+			stb.append(record, maf); record += '\t';
+			stb.append(record, v_errors); record += '\t';
+			stb.append(record, v_totals); record += '\t';
+			stb.append(record, v_totals?(v_errors*100.0f/v_totals):0.0f, 2); record += '\n';
+			fdv.write(chr, pos - 1, pos, record);
 		}
 		line++;
 		if (line % 10000 == 0) vrb.bullet("Processing VCF record: [" + stb.str(line) + "]");
+		if (checkpoint_every && line % checkpoint_every == 0) {
+			ckpt_chr = bcf_hdr_id2name(sr->readers[0].header, last_rid);
+			ckpt_pos = last_pos;
+			ckpt_ties = last_ties;
+			ckpt_line = line;
+			writeCheckpoint(fckpt, fdv);
+		}
 	}
-	fdv.close();
+	meter.stop();
+	if (fdv.close() < 0) vrb.error("Failed to write [" + foutput + ".var.txt.gz] or its index");
+	closeWindows();
 	free(gt_arr);
 	bcf_sr_destroy(sr);
+	if (meter.enabled()) vrb.bullet("#heap allocations in steady state = " + meter.str());
 
     //Per sample summary
 	vrb.title("Writing per sample summary in [" + foutput + "]");
-	output_file fds(foutput + ".ind.txt.gz");
+	bgzf_output_file fds(foutput + ".ind.txt.gz", 0, 0, 0, iop->size(), compression_level, -1, iop->get());
+	if (fds.fail()) vrb.error(fds.error);
 	for (int kidx = 0 ; kidx < samples.size() ; kidx++) {
-		fds << samples[kidx] << "\t" << ((fathers_idx[kidx]>=0)?samples[fathers_idx[kidx]]:"NA") << "\t" << ((mothers_idx[kidx]>=0)?samples[mothers_idx[kidx]]:"NA") << "\t" << mendel_errors[kidx] << "\t" << mendel_totals[kidx] << endl;
+		record.clear();
+		record += samples[kidx]; record += '\t';
+		record += (fathers_idx[kidx]>=0)?samples[fathers_idx[kidx]]:"NA"; record += '\t';
+		record += (mothers_idx[kidx]>=0)?samples[mothers_idx[kidx]]:"NA"; record += '\t';
+		stb.append(record, mendel_errors[kidx]); record += '\t';
+		stb.append(record, mendel_totals[kidx]); record += '\n';
+		fds.write(record);
 	}
-	fds.close();
+	if (fds.close() < 0) vrb.error("Failed to write [" + foutput + ".ind.txt.gz]");
+
+	//Per trio and MAF bin summary
+	if (!maf_bins.empty()) writeSummary(foutput + ".maf.txt.gz");
+	delete iop; iop = NULL;
+
+	//The run completed, checkpoint is not needed anymore
+	if (checkpoint_every || options.count("resume")) remove(fckpt.c_str());
 
 	//step2: Measure overall running time
 	vrb.title("Total running time = " + stb.str(tac.abs_time()) + " seconds");
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Copyright (C) 2020 Olivier Delaneau, University of Lausanne
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+#include <mendel/mendel_header.h>
+
+using namespace std;
+
+void mendel::initSummary() {
+	if (!options.count("maf-bins")) return;
+	vector < string > tokens;
+	stb.split(options["maf-bins"].as < string > (), tokens, ',');
+	for (int b = 0 ; b < tokens.size() ; b ++) {
+		if (!stb.numeric(tokens[b])) vrb.error("Non numeric MAF bin boundary [" + tokens[b] + "]");
+		maf_bins.push_back(stof(tokens[b]));
+		if (maf_bins.back() <= 0.0f || (b > 0 && maf_bins.back() <= maf_bins[b-1])) vrb.error("MAF bin boundaries must be positive and increasing");
+	}
+	//Implicit last bin up to 0.5 so that common variants are not counted in the last given one
+	if (maf_bins.back() < 0.5f) maf_bins.push_back(0.5f);
+	if (options.count("by-class")) classes = vector < string > { "SNP", "INDEL", "OTHER" };
+	else classes = vector < string > { "ALL" };
+
+	//One error and one total counter per trio/duo for each class and MAF bin
+	summary_errors = vector < int > (classes.size() * maf_bins.size() * (trios.size() / 3), 0);
+	summary_totals = vector < int > (classes.size() * maf_bins.size() * (trios.size() / 3), 0);
+}
+
+int mendel::getClass(bcf1_t * rec) {
+	if (classes.size() <= 1) return 0;
+	int type = bcf_get_variant_types(rec);
+	if (type == VCF_SNP) return 0;
+	if (type & VCF_INDEL) return 1;
+	return 2;
+}
+
+void mendel::writeSummary(string fsum) {
+	vrb.title("Writing per trio MAF binned summary in [" + fsum + "]");
+	bgzf_output_file fdm(fsum, 0, 0, 0, iop->size(), compression_level, -1, iop->get());
+	if (fdm.fail()) vrb.error(fdm.error);
+	fdm.write("#KID\tFATHER\tMOTHER\tCLASS\tMAF_FROM\tMAF_TO\tERRORS\tTOTALS\tRATE\n");
+	string record;
+	unsigned int ntrios = trios.size() / 3, nrows = 0;
+	for (int t = 0 ; t < ntrios ; t ++) {
+		for (int c = 0 ; c < classes.size() ; c ++) {
+			for (int b = 0 ; b < maf_bins.size() ; b ++) {
+				int idx = (c * maf_bins.size() + b) * ntrios + t;
+				if (!summary_totals[idx] && !summary_errors[idx]) continue;
+				record.clear();
+				record += samples[trios[3*t+0]]; record += '\t';
+				record += (trios[3*t+1] >= 0) ? samples[trios[3*t+1]] : "NA"; record += '\t';
+				record += (trios[3*t+2] >= 0) ? samples[trios[3*t+2]] : "NA"; record += '\t';
+				record += classes[c]; record += '\t';
+				stb.append(record, b ? maf_bins[b-1] : 0.0f); record += '\t';
+				stb.append(record, maf_bins[b]); record += '\t';
+				stb.append(record, summary_errors[idx]); record += '\t';
+				stb.append(record, summary_totals[idx]); record += '\t';
+				stb.append(record, summary_totals[idx]?(summary_errors[idx]*100.0f/summary_totals[idx]):0.0f, 2); record += '\n';
+				fdm.write(record);
+				nrows ++;
+			}
+		}
+	}
+	if (fdm.close() < 0) vrb.error("Failed to write [" + fsum + "]");
+	vrb.bullet("#rows = " + stb.str(nrows) + " (" + stb.str(classes.size()) + " classes x " + stb.str(maf_bins.size()) + " bins x " + stb.str(ntrios) + " trios/duos, empty cells skipped)");
+}
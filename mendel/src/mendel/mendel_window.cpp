@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright (C) 2020 Olivier Delaneau, University of Lausanne
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#include <mendel/mendel_header.h>
+
+using namespace std;
+
+void mendel::initWindows() {
+	if (options.count("window-bp")) window_bp = options["window-bp"].as < int > ();
+	else if (options.count("window-variants")) window_var = options["window-variants"].as < int > ();
+	else return;
+
+	//Only the current window is kept in memory: one error and one total counter per trio/duo
+	window_errors = vector < int > (trios.size() / 3, 0);
+	window_totals = vector < int > (trios.size() / 3, 0);
+	window_nvar = 0;
+}
+
+void mendel::openWindows(string fwin) {
+	if (!window_bp && !window_var) return;
+	fdw = new bgzf_output_file(fwin, 1, 2, 3, iop->size(), compression_level, ckpt_win_offset, iop->get());
+	if (fdw->fail()) vrb.error(fdw->error);
+	vrb.bullet("Windowed error tracks in [" + fwin + "]");
+	if (ckpt_win_offset < 0) fdw->write("#CHR\tSTART\tEND\tKID\tFATHER\tMOTHER\tNVAR\tERRORS\tTOTALS\tRATE\n");
+}
+
+void mendel::updateWindow(const string & chr, int pos) {
+	if (window_nvar) {
+		if (chr != window_chr) writeWindow();
+		else if (window_bp && (pos - 1) / window_bp != (window_start - 1) / window_bp) writeWindow();
+	}
+	if (!window_nvar) {
+		window_chr = chr;
+		window_start = window_bp ? ((pos - 1) / window_bp) * window_bp + 1 : pos;
+	}
+	window_end = pos;
+	window_nvar ++;
+}
+
+void mendel::writeWindow() {
+	if (!window_nvar) return;
+	int end = window_bp ? (window_start + window_bp - 1) : window_end;
+	string record;
+	for (int t = 0 ; t < window_totals.size() ; t ++) {
+		//Trios with no informative site in the window are skipped to keep the track compact
+		if (window_totals[t] || window_errors[t]) {
+			record.clear();
+			record += window_chr; record += '\t';
+			stb.append(record, window_start); record += '\t';
+			stb.append(record, end); record += '\t';
+			record += samples[trios[3*t+0]]; record += '\t';
+			record += (trios[3*t+1] >= 0) ? samples[trios[3*t+1]] : "NA"; record += '\t';
+			record += (trios[3*t+2] >= 0) ? samples[trios[3*t+2]] : "NA"; record += '\t';
+			stb.append(record, window_nvar); record += '\t';
+			stb.append(record, window_errors[t]); record += '\t';
+			stb.append(record, window_totals[t]); record += '\t';
+			stb.append(record, window_totals[t]?(window_errors[t]*100.0f/window_totals[t]):0.0f, 2); record += '\n';
+			fdw->write(window_chr, window_start - 1, end, record);
+		}
+		window_errors[t] = window_totals[t] = 0;
+	}
+	window_nvar = 0;
+}
+
+void mendel::closeWindows() {
+	if (!fdw) return;
+	writeWindow();
+	if (fdw->close() < 0) vrb.error("Failed to write the windowed error tracks or their index");
+	delete fdw;
+	fdw = NULL;
+}
@@ -0,0 +1 @@
+../../../common/src/utils/vcf_batch.h
\ No newline at end of file
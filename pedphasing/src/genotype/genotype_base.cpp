@@ -2,10 +2,24 @@
 
 using namespace std;
 
-genotype::genotype() {
-
+genotype::genotype(unsigned int nthreads) {
+	pool = new work_pool(nthreads);
+	iop = new io_pool(nthreads);
+	sr = NULL;
+	n_variant_tot = n_variant_set = 0;
+	hdr = NULL;
+	keep_records = false;
+	fdt = fds = NULL;
+	n_switches = 0;
+	n_sib_slots = 0;
+	n_sib_phased = 0;
+	est_samples = 0;
+	est_variants = est_record_bytes = est_sib_slots = 0;
+	write_index = false;
+	compression_level = -1;
 }
 
 genotype::~genotype() {
-
+	delete pool;
+	delete iop;
 }
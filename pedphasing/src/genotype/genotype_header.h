@@ -2,36 +2,114 @@
 #define _GENOTYPE_H
 
 #include <utils/otools.h>
+#include <genotype/genotype_matrix.h>
+
+//Haplotype transmission from a parent to a kid, with the last informative locus seen
+struct transmission_track {
+	int kid, parent, role;							//Role is 0 for the father and 1 for the mother
+	int last_hap, last_rid, last_pos;
+};
 
 class genotype {
 public:
 
 	std::vector < std::string > vec_names;				//samples ids in std::vector
-	std::map < std::string, int > map_names;				//samples ids in map
+	sample_index map_names;							//samples ids hashed, same order as vec_names
 	std::vector < int > fathers;					//father ids
 	std::vector < int > mothers;					//mother ids
+	std::vector < int > order;						//kids in topological order of the pedigree
 
-	std::vector < std::string > chr, id, ref, alt;
-	std::vector < int > pos;
+	std::vector < std::string > contigs;			//Contig names of the input header
+	std::vector < int > rid, pos;					//Contig and position of the variants in memory
+	std::vector < bcf1_t * > records;				//Input records of the variants in memory, when kept
+	bool keep_records;
 
 	std::vector < int > mendel_error;
 	std::vector < int > mendel_total;
+	std::vector < int > mendel_family;				//Mendel errors accumulated per kid
+	std::vector < std::vector < int > > mendel_thread;	//Mendel errors per thread and kid, before accumulation
+	std::vector < std::vector < uint64_t > > lock_thread;	//Loci already phased per thread and sample, within the current block
+
+	work_pool * pool;								//Solver threads
+	io_pool * iop;									//htslib threads shared by all input and output files
+
+	//Input / output streams
+	bcf_srs_t * sr;
+	std::vector < int * > gt_arr_thread;					//htslib genotype buffer per decoding thread
+	std::vector < int > ngt_arr_thread;
+	unsigned int n_variant_tot, n_variant_set;
+	vcf_output_file out;
+	bcf_hdr_t * hdr;
+	bool write_index;
+	std::string output_type;							//Forced output type (v, z, u or b), empty to use the file extension
+	int compression_level;							//Level of all compressed outputs, -1 for the default
+	std::vector < aligned_vector64 < uint64_t > > stage_thread;	//Variant-major copy of a block per decoding/encoding thread
+	std::vector < std::vector < int > > gt_thread;				//Genotypes of a record per encoding thread
+	std::vector < unsigned int > patched_thread;				//Records patched in place per encoding thread
+
+	genotype_matrix G;								//Bit-packed genotypes, phases and missingness
 
-	std::vector < std::vector < bool > > gen1;
-	std::vector < std::vector < bool > > gen2;
-	std::vector < std::vector < bool > > phas;
-	std::vector < std::vector < bool > > miss;
+	//Transmission tracking
+	std::vector < transmission_track > tracks;
+	std::vector < aligned_vector64 < uint64_t > > origin;	//Per block and sample, loci phased against the sample's own parents
+	bgzf_output_file * fdt, * fds;
+	unsigned long n_switches;
 
-	genotype();
+	//Sibling-aware phasing
+	std::vector < std::vector < int > > sibships;		//Full siblings in solving order, the first one being the reference
+	std::vector < int > sib_slot;						//Index of each sibling in the per sibling arrays, -1 otherwise
+	unsigned int n_sib_slots;
+	std::vector < aligned_vector64 < uint64_t > > sib_own;	//Per block and sibling, loci phased by its own trio
+	std::vector < int > ibd_state, ibd_rid;				//Per sibling and parent, IBD state with the reference at the last informative locus and its contig
+	std::vector < std::vector < int > > ibd_carry, ibd_carry_rid;	//Same, at the start of each block in memory
+	std::vector < std::vector < int > > ibd_next, ibd_next_rid;	//Per block in memory, state at the first informative locus after it and its contig
+	std::vector < unsigned int > sib_thread;			//Loci phased using siblings per thread
+	unsigned long n_sib_phased;
+
+	//Memory preflight
+	unsigned int est_samples;
+	unsigned long est_variants, est_record_bytes, est_sib_slots;
+
+	genotype(unsigned int nthreads = 1);
 	~genotype();
 
+	bool estimateMemory(std::string, std::string, std::string);
+	unsigned long memoryScratch();
+	unsigned long memorySiblings();
+	unsigned long memoryInMemory(bool);
+	unsigned long memoryStreaming(unsigned int, bool);
+
 	void readPedigrees(std::string);
 	void readGenotypes(std::string, std::string);
-	void writeGenotypes(std::string);
+	void writeGenotypes(std::string, std::string, std::string);
+
+	//Batch-wise I/O used for streaming
+	void openReader(std::string, std::string);
+	unsigned int readVariants(unsigned int);
+	void decodeBlock(unsigned int, unsigned int, bcf1_t **, unsigned int);
+	void closeReader();
+	void openWriter(std::string, bcf_hdr_t *);
+	bool patchRecord(bcf1_t *, int *);
+	void patchBlock(unsigned int, unsigned int, bcf1_t **, unsigned int);
+	void writeBlocks(unsigned int, unsigned int, unsigned int);
+	void writeVariants();
+	void closeWriter();
 
-	bool solveTrio(int locus, int cidx, int fidx, int midx);
-	bool solveDuoFather(int locus, int cidx, int pidx);
-	bool solveDuoMother(int locus, int cidx, int pidx);
+	int solveTrio(genotype_cell & C, genotype_cell & F, genotype_cell & M, uint64_t mask, uint64_t & lockC, uint64_t & lockF, uint64_t & lockM);
+	int solveDuoFather(genotype_cell & C, genotype_cell & P, uint64_t mask, uint64_t & lockC, uint64_t & lockP);
+	int solveDuoMother(genotype_cell & C, genotype_cell & P, uint64_t mask, uint64_t & lockC, uint64_t & lockP);
+	void sortPedigrees();
+	void groupSiblings();
+	void informativeSiblings(unsigned int, const std::vector < int > &, int, int, uint64_t &, uint64_t &);
+	int stateSiblings(unsigned int, unsigned int, int, int, uint64_t, uint64_t);
+	void carrySiblings();
+	unsigned int solveSiblings(unsigned int);
+	void solveBlock(unsigned int, std::vector < int > &, std::vector < uint64_t > &);
+	void solveVariants();
+	void openTransmission(std::string);
+	void trackTransmissions();
+	void closeTransmission();
+	void reportMendel();
 	void solvePedigrees();
 };
 
@@ -0,0 +1,143 @@
+#include <genotype/genotype_matrix.h>
+
+using namespace std;
+
+genotype_matrix::genotype_matrix() {
+	n_samples = n_variants = n_words = n_blocks = 0;
+	staged_block = -1;
+	staged_count = 0;
+}
+
+genotype_matrix::~genotype_matrix() {
+}
+
+void genotype_matrix::allocate(unsigned int _n_samples) {
+	n_samples = _n_samples;
+	n_words = DIVU(n_samples, 64);
+	blocks.clear();
+	staging = aligned_vector64 < uint64_t > (4 * n_words * GMAT_BLOCK, 0);
+	clear();
+}
+
+void genotype_matrix::clear() {
+	n_blocks = 0;
+	n_variants = 0;
+	staged_block = -1;
+	staged_count = 0;
+}
+
+//In-place transposition of a 64x64 bit matrix: bit c of tile[r] moves to bit r of tile[c]
+void genotype_matrix::transpose(uint64_t * tile) {
+	uint64_t m = 0x00000000FFFFFFFFULL;
+	for (unsigned int j = 32 ; j ; j >>= 1, m ^= (m << j)) {
+		for (unsigned int k = 0 ; k < 64 ; k = ((k | j) + 1) & ~j) {
+			uint64_t t = ((tile[k] >> j) ^ tile[k | j]) & m;
+			tile[k | j] ^= t;
+			tile[k] ^= (t << j);
+		}
+	}
+}
+
+//Encodes one variant into row r of a staging area
+void genotype_matrix::encodeVariant(uint64_t * stage, unsigned int r, const int * gt_arr) {
+	for (unsigned int w = 0 ; w < n_words ; w ++) {
+		uint64_t h0 = 0, h1 = 0, phas = 0, miss = 0;
+		unsigned int i0 = w * 64, i1 = min(n_samples, i0 + 64);
+		for (unsigned int i = i0 ; i < i1 ; i ++) {
+			int a0 = gt_arr[2*i+0], a1 = gt_arr[2*i+1];
+			uint64_t bit = 1ULL << (i - i0);
+			h0 |= (bcf_gt_allele(a0) != 0) ? bit : 0;
+			h1 |= (bcf_gt_allele(a1) != 0) ? bit : 0;
+			phas |= (bcf_gt_is_phased(a0) && bcf_gt_is_phased(a1)) ? bit : 0;
+			miss |= (a0 == bcf_gt_missing || a1 == bcf_gt_missing) ? bit : 0;
+		}
+		stage[(0 * n_words + w) * GMAT_BLOCK + r] = h0;
+		stage[(1 * n_words + w) * GMAT_BLOCK + r] = h1;
+		stage[(2 * n_words + w) * GMAT_BLOCK + r] = phas;
+		stage[(3 * n_words + w) * GMAT_BLOCK + r] = miss;
+	}
+}
+
+//Moves the n first rows of a staging area into block b; unused variant slots are flagged missing. The staging area is consumed.
+void genotype_matrix::storeBlock(unsigned int b, uint64_t * stage, unsigned int n) {
+	aligned_vector64 < genotype_cell > & block = blocks[b];
+	for (unsigned int w = 0 ; w < n_words ; w ++) {
+		unsigned int ns = min(64U, n_samples - w * 64);
+		for (unsigned int p = 0 ; p < 4 ; p ++) {
+			uint64_t * t = stage + (p * n_words + w) * GMAT_BLOCK;
+			for (unsigned int r = n ; r < GMAT_BLOCK ; r ++) t[r] = (p == 3) ? ~0ULL : 0ULL;
+			transpose(t);
+			for (unsigned int k = 0 ; k < ns ; k ++) ((uint64_t*)&block[w * 64 + k])[p] = t[k];
+		}
+	}
+}
+
+//Sets the number of variants, allocating the blocks they need; blocks are then filled with storeBlock
+void genotype_matrix::resize(unsigned int _n_variants) {
+	n_variants = _n_variants;
+	n_blocks = DIVU(n_variants, GMAT_BLOCK);
+	while (blocks.size() < n_blocks) blocks.emplace_back(n_samples);
+}
+
+void genotype_matrix::pushVariant(const int * gt_arr) {
+	staged_block = -1;
+	encodeVariant(staging.data(), staged_count, gt_arr);
+	n_variants ++;
+	if (++staged_count == GMAT_BLOCK) stage2block();
+}
+
+void genotype_matrix::finalize() {
+	if (staged_count) stage2block();
+}
+
+void genotype_matrix::stage2block() {
+	if (n_blocks == blocks.size()) blocks.emplace_back(n_samples);
+	storeBlock(n_blocks ++, staging.data(), staged_count);
+	staged_count = 0;
+}
+
+//Copies block b back to the variant-major layout: tile of plane p and word w starts at stage[(p * n_words + w) * 64]
+void genotype_matrix::loadBlock(unsigned int b, uint64_t * stage) {
+	aligned_vector64 < genotype_cell > & block = blocks[b];
+	for (unsigned int w = 0 ; w < n_words ; w ++) {
+		unsigned int n = min(64U, n_samples - w * 64);
+		for (unsigned int p = 0 ; p < 4 ; p ++) {
+			uint64_t * t = stage + (p * n_words + w) * GMAT_BLOCK;
+			for (unsigned int k = 0 ; k < n ; k ++) t[k] = ((uint64_t*)&block[w * 64 + k])[p];
+			for (unsigned int k = n ; k < 64 ; k ++) t[k] = 0;
+			transpose(t);
+		}
+	}
+}
+
+void genotype_matrix::decodeVariant(const uint64_t * stage, unsigned int r, int * gt_arr) {
+	for (unsigned int w = 0 ; w < n_words ; w ++) {
+		uint64_t h0 = stage[(0 * n_words + w) * GMAT_BLOCK + r];
+		uint64_t h1 = stage[(1 * n_words + w) * GMAT_BLOCK + r];
+		uint64_t phas = stage[(2 * n_words + w) * GMAT_BLOCK + r];
+		uint64_t miss = stage[(3 * n_words + w) * GMAT_BLOCK + r];
+		unsigned int i0 = w * 64, i1 = min(n_samples, i0 + 64);
+		for (unsigned int i = i0 ; i < i1 ; i ++) {
+			unsigned int s = i - i0;
+			if ((miss >> s) & 1) {
+				gt_arr[2*i+0] = bcf_gt_missing;
+				gt_arr[2*i+1] = bcf_gt_missing;
+			} else if ((phas >> s) & 1) {
+				gt_arr[2*i+0] = bcf_gt_phased((h0 >> s) & 1);
+				gt_arr[2*i+1] = bcf_gt_phased((h1 >> s) & 1);
+			} else {
+				gt_arr[2*i+0] = bcf_gt_unphased((h0 >> s) & 1);
+				gt_arr[2*i+1] = bcf_gt_unphased((h1 >> s) & 1);
+			}
+		}
+	}
+}
+
+void genotype_matrix::getVariant(unsigned int v, int * gt_arr) {
+	unsigned int b = v / GMAT_BLOCK, r = v % GMAT_BLOCK;
+	if (staged_block != (int)b) {
+		loadBlock(b, staging.data());
+		staged_block = b;
+	}
+	decodeVariant(staging.data(), r, gt_arr);
+}
@@ -0,0 +1,61 @@
+#ifndef _GENOTYPE_MATRIX_H
+#define _GENOTYPE_MATRIX_H
+
+#include <utils/otools.h>
+
+#define GMAT_BLOCK	64
+
+//64 consecutive variants of one sample, one bit per variant in each plane
+struct genotype_cell {
+	uint64_t h0;		//First allele is ALT
+	uint64_t h1;		//Second allele is ALT
+	uint64_t phas;		//Genotype is phased
+	uint64_t miss;		//Genotype is missing (also set for padding past the last variant)
+};
+
+//Genotypes stored as blocks of 64 variants x all samples, sample-major within a block.
+//Records are decoded variant-major into a staging block and moved to the sample-major
+//layout by 64x64 bit transpositions, and back again when writing.
+class genotype_matrix {
+public:
+	unsigned int n_samples;
+	unsigned int n_variants;
+	unsigned int n_words;										//Number of 64-sample words per variant
+	unsigned int n_blocks;										//Number of blocks in use; allocated blocks are kept for reuse
+	std::vector < aligned_vector64 < genotype_cell > > blocks;
+
+	genotype_matrix();
+	~genotype_matrix();
+
+	void allocate(unsigned int _n_samples);
+	void clear();
+
+	//Variant-major I/O through the internal staging area: variants must be pushed, and read back, in increasing order
+	void pushVariant(const int * gt_arr);
+	void finalize();
+	void getVariant(unsigned int v, int * gt_arr);
+
+	//Thread safe variant-major I/O on distinct blocks: each thread provides its own staging area of stagingSize() words
+	unsigned int stagingSize() const { return 4 * n_words * GMAT_BLOCK; }
+	void resize(unsigned int _n_variants);
+	void encodeVariant(uint64_t * stage, unsigned int r, const int * gt_arr);
+	void storeBlock(unsigned int b, uint64_t * stage, unsigned int n);
+	void loadBlock(unsigned int b, uint64_t * stage);
+	void decodeVariant(const uint64_t * stage, unsigned int r, int * gt_arr);
+
+	//Sample-major access for solving; safe from several threads working on distinct blocks
+	unsigned int nBlocks() const { return n_blocks; }
+	genotype_cell & get(unsigned int b, unsigned int i) { return blocks[b][i]; }
+	void invalidate() { staged_block = -1; }					//Must be called once blocks are modified through get()
+
+	static void transpose(uint64_t * tile);
+
+private:
+	aligned_vector64 < uint64_t > staging;						//4 planes x n_words tiles x 64 variants
+	int staged_block;											//Block currently held in the staging area; -1 if none
+	unsigned int staged_count;									//Number of variants pushed in the staging area
+
+	void stage2block();
+};
+
+#endif
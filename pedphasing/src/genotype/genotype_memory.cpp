@@ -0,0 +1,82 @@
+#include <genotype/genotype_header.h>
+
+using namespace std;
+
+//Preflight: the number of records in the region is taken from the index statistics, prorated by the
+//fraction of the contig covered by the region, and the size of a record from the first one of the region.
+//The number of full siblings comes from the pedigree, grouped as groupSiblings does once it is read.
+//Returns false when the index does not carry record counts.
+bool genotype::estimateMemory(string fgen, string region, string fped) {
+	bcf_srs_t * sr_est =  bcf_sr_init();
+	if (region != "" && bcf_sr_set_regions(sr_est, region.c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + region + "]");
+	if(!(bcf_sr_add_reader (sr_est, fgen.c_str()))) vrb.error("Impossible to read header of [" + fgen + "]");
+	bcf_hdr_t * hdr_est = sr_est->readers[0].header;
+	est_samples = bcf_hdr_nsamples(hdr_est);
+	est_variants = est_record_bytes = est_sib_slots = 0;
+
+	//Record counts from the index; tabix has its own contig ids
+	bool counted = false;
+	hts_pos_t rbeg = 0, rend = HTS_POS_MAX;
+	const char * rchr = hts_parse_reg64(region.c_str(), &rbeg, &rend);
+	string chr = rchr ? string(region.c_str(), rchr) : region;
+	int rid_hdr = bcf_hdr_name2id(hdr_est, chr.c_str());
+	tbx_t * tbx = sr_est->readers[0].tbx_idx;
+	hts_idx_t * idx = tbx ? tbx->idx : sr_est->readers[0].bcf_idx;
+	int tid = tbx ? tbx_name2id(tbx, chr.c_str()) : rid_hdr;
+	uint64_t mapped = 0, unmapped = 0;
+	if (idx && tid >= 0 && hts_idx_get_stat(idx, tid, &mapped, &unmapped) == 0) {
+		counted = true;
+		est_variants = mapped;
+		hts_pos_t length = (rid_hdr >= 0 && hdr_est->id[BCF_DT_CTG][rid_hdr].val) ? hdr_est->id[BCF_DT_CTG][rid_hdr].val->info[0] : 0;
+		if (length > 0 && rend < HTS_POS_MAX) est_variants = (unsigned long)ceil(mapped * min(1.0, (double)(min(rend, length) - rbeg) / length));
+	}
+
+	//Footprint of a record once in memory
+	if (bcf_sr_next_line (sr_est)) {
+		bcf1_t * line = bcf_sr_get_line(sr_est, 0);
+		est_record_bytes = sizeof(bcf1_t) + line->shared.m + line->indiv.m;
+	}
+
+	//Kids with both parents genotyped, by pair of parents
+	sample_index names_est (est_samples);
+	for (unsigned int i = 0 ; i < est_samples ; i ++) names_est.insert(hdr_est->samples[i]);
+	bcf_sr_destroy(sr_est);
+	string_view buffer;
+	vector < string_view > str;
+	map < pair < int, int >, int > parents2size;
+	bgzf_input_file fd (fped);
+	if (fd.fail()) vrb.error("Cannot open file!");
+	while (fd.getline(buffer)) {
+		if (stb.tokenize(buffer, str) < 3) continue;
+		int f = names_est.find(str[1]), m = names_est.find(str[2]);
+		if (names_est.find(str[0]) >= 0 && f >= 0 && m >= 0) parents2size[pair < int, int > (f, m)] ++;
+	}
+	for (map < pair < int, int >, int > :: iterator it = parents2size.begin() ; it != parents2size.end() ; ++it) if (it->second > 1) est_sib_slots += it->second;
+	return counted;
+}
+
+//Scratch space common to both strategies: decoding/encoding buffers per thread and a chunk of records while re-reading
+unsigned long genotype::memoryScratch() {
+	unsigned long n_words = DIVU(est_samples, 64);
+	unsigned long per_thread = 4 * n_words * GMAT_BLOCK * sizeof(uint64_t) + 2 * 2 * est_samples * sizeof(int) + est_samples * sizeof(uint64_t);
+	return pool->size() * (per_thread + 4 * GMAT_BLOCK * est_record_bytes);
+}
+
+//Per block state of the full siblings: loci phased by their own trio, IBD states carried forwards and backwards
+unsigned long genotype::memorySiblings() {
+	return est_sib_slots * (sizeof(uint64_t) + 8 * sizeof(int));
+}
+
+//The whole region is held in the bit-packed matrix; records are re-read by chunks when writing
+unsigned long genotype::memoryInMemory(bool transmission) {
+	unsigned long n_blocks = DIVU(est_variants, GMAT_BLOCK);
+	unsigned long per_block = est_samples * (sizeof(genotype_cell) + (transmission ? sizeof(uint64_t) : 0)) + GMAT_BLOCK * 2 * sizeof(int) + memorySiblings();
+	return n_blocks * per_block + memoryScratch();
+}
+
+//Only one batch of variants is held, together with its records
+unsigned long genotype::memoryStreaming(unsigned int batch, bool transmission) {
+	unsigned long n_blocks = DIVU(batch, GMAT_BLOCK);
+	unsigned long per_block = est_samples * (sizeof(genotype_cell) + (transmission ? sizeof(uint64_t) : 0)) + GMAT_BLOCK * (2 * sizeof(int) + sizeof(bcf1_t *) + est_record_bytes) + memorySiblings();
+	return n_blocks * per_block + memoryScratch();
+}
@@ -2,128 +2,232 @@
 
 using namespace std;
 
-bool genotype::solveTrio(int locus, int cidx, int fidx, int midx) {
-	int cg = gen1[cidx][locus] + gen2[cidx][locus];
-	int fg = gen1[fidx][locus] + gen2[fidx][locus];
-	int mg = gen1[midx][locus] + gen2[midx][locus];
-	int phased = 0, mendel = 0;
-	bool c0 = false, c1 = false, f0 = false, f1 = false, m0 = false, m1 = false;
-	if (fg == 0 && mg == 0 && cg == 0) { f0 = 0; f1 = 0; m0 = 0; m1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 0 && mg == 0 && cg == 1) { f0 = 0; f1 = 0; m0 = 0; m1 = 0; c0 = 0; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 0 && mg == 0 && cg == 2) { f0 = 0; f1 = 0; m0 = 0; m1 = 0; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 0 && mg == 1 && cg == 0) { f0 = 0; f1 = 0; m0 = 1; m1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 0 && mg == 1 && cg == 1) { f0 = 0; f1 = 0; m0 = 0; m1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 0 && mg == 1 && cg == 2) { f0 = 0; f1 = 0; m0 = 0; m1 = 1; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 0 && mg == 2 && cg == 0) { f0 = 0; f1 = 0; m0 = 1; m1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (fg == 0 && mg == 2 && cg == 1) { f0 = 0; f1 = 0; m0 = 1; m1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 0 && mg == 2 && cg == 2) { f0 = 0; f1 = 0; m0 = 1; m1 = 1; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 1 && mg == 0 && cg == 0) { f0 = 0; f1 = 1; m0 = 0; m1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 1 && mg == 0 && cg == 1) { f0 = 1; f1 = 0; m0 = 0; m1 = 0; c0 = 1; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 1 && mg == 0 && cg == 2) { f0 = 1; f1 = 0; m0 = 0; m1 = 0; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 1 && mg == 1 && cg == 0) { f0 = 0; f1 = 1; m0 = 1; m1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 1 && mg == 1 && cg == 1) { f0 = 0; f1 = 1; m0 = 0; m1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 0;}
-	if (fg == 1 && mg == 1 && cg == 2) { f0 = 1; f1 = 0; m0 = 0; m1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 1 && mg == 2 && cg == 0) { f0 = 0; f1 = 1; m0 = 1; m1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (fg == 1 && mg == 2 && cg == 1) { f0 = 0; f1 = 1; m0 = 1; m1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 1 && mg == 2 && cg == 2) { f0 = 1; f1 = 0; m0 = 1; m1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 2 && mg == 0 && cg == 0) { f0 = 1; f1 = 1; m0 = 0; m1 = 0; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (fg == 2 && mg == 0 && cg == 1) { f0 = 1; f1 = 1; m0 = 0; m1 = 0; c0 = 1; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 2 && mg == 0 && cg == 2) { f0 = 1; f1 = 1; m0 = 0; m1 = 0; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 2 && mg == 1 && cg == 0) { f0 = 1; f1 = 1; m0 = 0; m1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (fg == 2 && mg == 1 && cg == 1) { f0 = 1; f1 = 1; m0 = 1; m1 = 0; c0 = 1; c1 = 0; mendel = 0; phased = 1;}
-	if (fg == 2 && mg == 1 && cg == 2) { f0 = 1; f1 = 1; m0 = 0; m1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	if (fg == 2 && mg == 2 && cg == 0) { f0 = 1; f1 = 1; m0 = 1; m1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (fg == 2 && mg == 2 && cg == 1) { f0 = 1; f1 = 1; m0 = 1; m1 = 1; c0 = 0; c1 = 1; mendel = 1; phased = 0;}
-	if (fg == 2 && mg == 2 && cg == 2) { f0 = 1; f1 = 1; m0 = 1; m1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	gen1[cidx][locus] = c0; gen2[cidx][locus] = c1; gen1[fidx][locus] = f0; gen2[fidx][locus] = f1; gen1[midx][locus] = m0; gen2[midx][locus] = m1;
-	phas[cidx][locus] = phased;
-	phas[fidx][locus] = phased;
-	phas[midx][locus] = phased;
-	if (mendel) return true;
-	else return false;
+//Trio outcomes indexed by father/mother/child dosages: {f0, f1, m0, m1, c0, c1, mendel, phased}
+static const unsigned char trio_table [27][8] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 1 },	//F=0 M=0 C=0
+	{ 0, 0, 0, 0, 0, 1, 1, 0 },	//F=0 M=0 C=1
+	{ 0, 0, 0, 0, 1, 1, 1, 0 },	//F=0 M=0 C=2
+	{ 0, 0, 1, 0, 0, 0, 0, 1 },	//F=0 M=1 C=0
+	{ 0, 0, 0, 1, 0, 1, 0, 1 },	//F=0 M=1 C=1
+	{ 0, 0, 0, 1, 1, 1, 1, 0 },	//F=0 M=1 C=2
+	{ 0, 0, 1, 1, 0, 0, 1, 0 },	//F=0 M=2 C=0
+	{ 0, 0, 1, 1, 0, 1, 0, 1 },	//F=0 M=2 C=1
+	{ 0, 0, 1, 1, 1, 1, 1, 0 },	//F=0 M=2 C=2
+	{ 0, 1, 0, 0, 0, 0, 0, 1 },	//F=1 M=0 C=0
+	{ 1, 0, 0, 0, 1, 0, 0, 1 },	//F=1 M=0 C=1
+	{ 1, 0, 0, 0, 1, 1, 1, 0 },	//F=1 M=0 C=2
+	{ 0, 1, 1, 0, 0, 0, 0, 1 },	//F=1 M=1 C=0
+	{ 0, 1, 0, 1, 0, 1, 0, 0 },	//F=1 M=1 C=1
+	{ 1, 0, 0, 1, 1, 1, 0, 1 },	//F=1 M=1 C=2
+	{ 0, 1, 1, 1, 0, 0, 1, 0 },	//F=1 M=2 C=0
+	{ 0, 1, 1, 1, 0, 1, 0, 1 },	//F=1 M=2 C=1
+	{ 1, 0, 1, 1, 1, 1, 0, 1 },	//F=1 M=2 C=2
+	{ 1, 1, 0, 0, 0, 0, 1, 0 },	//F=2 M=0 C=0
+	{ 1, 1, 0, 0, 1, 0, 0, 1 },	//F=2 M=0 C=1
+	{ 1, 1, 0, 0, 1, 1, 1, 0 },	//F=2 M=0 C=2
+	{ 1, 1, 0, 1, 0, 0, 1, 0 },	//F=2 M=1 C=0
+	{ 1, 1, 1, 0, 1, 0, 0, 1 },	//F=2 M=1 C=1
+	{ 1, 1, 0, 1, 1, 1, 0, 1 },	//F=2 M=1 C=2
+	{ 1, 1, 1, 1, 0, 0, 1, 0 },	//F=2 M=2 C=0
+	{ 1, 1, 1, 1, 0, 1, 1, 0 },	//F=2 M=2 C=1
+	{ 1, 1, 1, 1, 1, 1, 0, 1 },	//F=2 M=2 C=2
+};
+
+//Duo outcomes indexed by parent/child dosages: {p0, p1, c0, c1, mendel, phased}
+static const unsigned char duo_father_table [9][6] = {
+	{ 0, 0, 0, 0, 0, 1 },	//P=0 C=0
+	{ 0, 0, 0, 1, 0, 1 },	//P=0 C=1
+	{ 0, 0, 1, 1, 1, 0 },	//P=0 C=2
+	{ 0, 1, 0, 0, 0, 1 },	//P=1 C=0
+	{ 0, 1, 0, 1, 0, 0 },	//P=1 C=1
+	{ 1, 0, 1, 1, 0, 1 },	//P=1 C=2
+	{ 1, 1, 0, 0, 1, 0 },	//P=2 C=0
+	{ 1, 1, 1, 0, 0, 1 },	//P=2 C=1
+	{ 1, 1, 1, 1, 0, 1 },	//P=2 C=2
+};
+
+static const unsigned char duo_mother_table [9][6] = {
+	{ 0, 0, 0, 0, 0, 1 },	//P=0 C=0
+	{ 0, 0, 1, 0, 0, 1 },	//P=0 C=1
+	{ 0, 0, 1, 1, 1, 0 },	//P=0 C=2
+	{ 1, 0, 0, 0, 0, 1 },	//P=1 C=0
+	{ 0, 1, 0, 1, 0, 0 },	//P=1 C=1
+	{ 0, 1, 1, 1, 0, 1 },	//P=1 C=2
+	{ 1, 1, 0, 0, 1, 0 },	//P=2 C=0
+	{ 1, 1, 0, 1, 0, 1 },	//P=2 C=1
+	{ 1, 1, 1, 1, 0, 1 },	//P=2 C=2
+};
+
+//Bit masks of the loci carrying 0, 1 or 2 ALT alleles
+static inline void getDosages(const genotype_cell & g, uint64_t * d) {
+	d[0] = ~(g.h0 | g.h1);
+	d[1] = g.h0 ^ g.h1;
+	d[2] = g.h0 & g.h1;
+}
+
+static inline void setCell(genotype_cell & g, uint64_t mask, uint64_t h0, uint64_t h1, uint64_t phas) {
+	g.h0 = (g.h0 & ~mask) | h0;
+	g.h1 = (g.h1 & ~mask) | h1;
+	g.phas = (g.phas & ~mask) | phas;
 }
 
-bool genotype::solveDuoFather(int locus, int cidx, int pidx) {
-	int cg = gen1[cidx][locus] + gen2[cidx][locus];
-	int pg = gen1[pidx][locus] + gen2[pidx][locus];
-	bool c0 = false, c1 = false, p0 = false, p1 = false;
-	int phased = 0, mendel = 0;
-	if (pg == 0 && cg == 0) { p0 = 0; p1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 0 && cg == 1) { p0 = 0; p1 = 0; c0 = 0; c1 = 1; mendel = 0; phased = 1;}
-	if (pg == 0 && cg == 2) { p0 = 0; p1 = 0; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (pg == 1 && cg == 0) { p0 = 0; p1 = 1; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 1 && cg == 1) { p0 = 0; p1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 0;}
-	if (pg == 1 && cg == 2) { p0 = 1; p1 = 0; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	if (pg == 2 && cg == 0) { p0 = 1; p1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (pg == 2 && cg == 1) { p0 = 1; p1 = 1; c0 = 1; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 2 && cg == 2) { p0 = 1; p1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	gen1[cidx][locus] = c0; gen2[cidx][locus] = c1; gen1[pidx][locus] = p0; gen2[pidx][locus] = p1;
-	phas[cidx][locus] = phased;
-	phas[pidx][locus] = phased;
-	if (mendel) return true;
-	else return false;
+//Solves the 64 loci of a block at once: each dosage combination selects its loci and sets the corresponding outcome bits
+//Parents whose phase is locked at some loci keep their haplotypes there; the kid is phased against them as is
+int genotype::solveTrio(genotype_cell & C, genotype_cell & F, genotype_cell & M, uint64_t mask, uint64_t & lockC, uint64_t & lockF, uint64_t & lockM) {
+	if (!mask) return 0;
+	uint64_t cd[3], fd[3], md[3], o[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	getDosages(C, cd); getDosages(F, fd); getDosages(M, md);
+	for (int f = 0 ; f < 3 ; f ++) for (int m = 0 ; m < 3 ; m ++) {
+		uint64_t fm = fd[f] & md[m] & mask;
+		if (!fm) continue;
+		for (int c = 0 ; c < 3 ; c ++) {
+			uint64_t sel = fm & cd[c];
+			const unsigned char * t = trio_table[f * 9 + m * 3 + c];
+			for (int k = 0 ; k < 8 ; k ++) o[k] |= (-(uint64_t)t[k]) & sel;
+		}
+	}
+	uint64_t maskF = mask & ~lockF, maskM = mask & ~lockM;
+	setCell(C, mask, o[4], o[5], o[7]);
+	setCell(F, maskF, o[0] & maskF, o[1] & maskF, o[7] & maskF);
+	setCell(M, maskM, o[2] & maskM, o[3] & maskM, o[7] & maskM);
+	lockC |= o[7]; lockF |= o[7]; lockM |= o[7];
+	return __builtin_popcountll(o[6]);
 }
 
-bool genotype::solveDuoMother(int locus, int cidx, int pidx) {
-	int cg = gen1[cidx][locus] + gen2[cidx][locus];
-	int pg = gen1[pidx][locus] + gen2[pidx][locus];
-	bool c0 = false, c1 = false, p0 = false, p1 = false;
-	int phased = 0, mendel = 0;
-	if (pg == 0 && cg == 0) { p0 = 0; p1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 0 && cg == 1) { p0 = 0; p1 = 0; c0 = 1; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 0 && cg == 2) { p0 = 0; p1 = 0; c0 = 1; c1 = 1; mendel = 1; phased = 0;}
-	if (pg == 1 && cg == 0) { p0 = 1; p1 = 0; c0 = 0; c1 = 0; mendel = 0; phased = 1;}
-	if (pg == 1 && cg == 1) { p0 = 0; p1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 0;}
-	if (pg == 1 && cg == 2) { p0 = 0; p1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	if (pg == 2 && cg == 0) { p0 = 1; p1 = 1; c0 = 0; c1 = 0; mendel = 1; phased = 0;}
-	if (pg == 2 && cg == 1) { p0 = 1; p1 = 1; c0 = 0; c1 = 1; mendel = 0; phased = 1;}
-	if (pg == 2 && cg == 2) { p0 = 1; p1 = 1; c0 = 1; c1 = 1; mendel = 0; phased = 1;}
-	gen1[cidx][locus] = c0; gen2[cidx][locus] = c1; gen1[pidx][locus] = p0; gen2[pidx][locus] = p1;
-	phas[cidx][locus] = phased;
-	phas[pidx][locus] = phased;
-	if (mendel) return true;
-	else return false;
+static inline int solveDuo(const unsigned char table [9][6], genotype_cell & C, genotype_cell & P, uint64_t mask, uint64_t & lockC, uint64_t & lockP) {
+	if (!mask) return 0;
+	uint64_t cd[3], pd[3], o[6] = { 0, 0, 0, 0, 0, 0 };
+	getDosages(C, cd); getDosages(P, pd);
+	for (int p = 0 ; p < 3 ; p ++) for (int c = 0 ; c < 3 ; c ++) {
+		uint64_t sel = pd[p] & cd[c] & mask;
+		for (int k = 0 ; k < 6 ; k ++) o[k] |= (-(uint64_t)table[p * 3 + c][k]) & sel;
+	}
+	uint64_t maskP = mask & ~lockP;
+	setCell(C, mask, o[2], o[3], o[5]);
+	setCell(P, maskP, o[0] & maskP, o[1] & maskP, o[5] & maskP);
+	lockC |= o[5]; lockP |= o[5];
+	return __builtin_popcountll(o[4]);
 }
 
-void genotype::solvePedigrees() {
-	vrb.title("Solving pedigrees");
+int genotype::solveDuoFather(genotype_cell & C, genotype_cell & P, uint64_t mask, uint64_t & lockC, uint64_t & lockP) {
+	return solveDuo(duo_father_table, C, P, mask, lockC, lockP);
+}
+
+int genotype::solveDuoMother(genotype_cell & C, genotype_cell & P, uint64_t mask, uint64_t & lockC, uint64_t & lockP) {
+	return solveDuo(duo_mother_table, C, P, mask, lockC, lockP);
+}
+
+//Solves all families over one block in topological order, so that a kid is phased after its own parents.
+//Loci where a sample got phased earlier in the block are locked and reused when it is solved again as a parent.
+void genotype::solveBlock(unsigned int b, vector < int > & mendel, vector < uint64_t > & lock) {
+	for (int o = 0 ; o < order.size() ; o++) {
+		int i = order[o], f = fathers[i], m = mothers[i];
+		genotype_cell & C = G.get(b, i);
+		uint64_t kid_ok = ~C.miss;
+		//Trio case, falling back to duos at loci with one missing parent
+		if (f >= 0 && m >= 0) {
+			genotype_cell & F = G.get(b, f);
+			genotype_cell & M = G.get(b, m);
+			mendel[i] += solveTrio(C, F, M, kid_ok & ~F.miss & ~M.miss, lock[i], lock[f], lock[m]);
+			mendel[i] += solveDuoFather(C, F, kid_ok & ~F.miss & M.miss, lock[i], lock[f]);
+			mendel[i] += solveDuoMother(C, M, kid_ok & F.miss & ~M.miss, lock[i], lock[m]);
+		}
+		//Duo father case
+		else if (f >= 0) {
+			genotype_cell & F = G.get(b, f);
+			mendel[i] += solveDuoFather(C, F, kid_ok & ~F.miss, lock[i], lock[f]);
+		}
+		//Duo mother case
+		else {
+			genotype_cell & M = G.get(b, m);
+			mendel[i] += solveDuoMother(C, M, kid_ok & ~M.miss, lock[i], lock[m]);
+		}
+		//At this point, the kid is only locked where its own family phased it
+		if (fdt) origin[b][i] = lock[i];
+		if (sib_slot[i] >= 0) sib_own[b][sib_slot[i]] = lock[i];
+	}
+	for (int o = 0 ; o < order.size() ; o++) {
+		int i = order[o];
+		lock[i] = 0;
+		if (fathers[i] >= 0) lock[fathers[i]] = 0;
+		if (mothers[i] >= 0) lock[mothers[i]] = 0;
+	}
+}
+
+//Orders families so that parents are solved as kids before being solved as parents (Kahn's algorithm)
+void genotype::sortPedigrees() {
+	int n = vec_names.size(), n_gen = 0;
+	vector < int > indegree = vector < int > (n, 0), generation = vector < int > (n, 0);
+	vector < vector < int > > children = vector < vector < int > > (n);
+	for (int i = 0 ; i < n ; i ++) {
+		if (fathers[i] >= 0) { children[fathers[i]].push_back(i); indegree[i] ++; }
+		if (mothers[i] >= 0) { children[mothers[i]].push_back(i); indegree[i] ++; }
+	}
+	//Samples are dequeued in index order within a generation, which makes the order deterministic
+	vector < int > queue;
+	for (int i = 0 ; i < n ; i ++) if (!indegree[i]) queue.push_back(i);
+	order.clear();
+	for (int q = 0 ; q < queue.size() ; q ++) {
+		int i = queue[q];
+		if (fathers[i] >= 0 || mothers[i] >= 0) {
+			order.push_back(i);
+			n_gen = max(n_gen, generation[i]);
+		}
+		for (int c = 0 ; c < children[i].size() ; c ++) {
+			int k = children[i][c];
+			generation[k] = max(generation[k], generation[i] + 1);
+			if (--indegree[k] == 0) queue.push_back(k);
+		}
+	}
+	if (queue.size() != n) vrb.error("Pedigree contains a cycle: " + stb.str(n - queue.size()) + " samples are their own ancestors");
+	vrb.bullet("#families = " + stb.str(order.size()) + " / #generations = " + stb.str(n_gen + 1));
+}
+
+//Solves all families over the variants currently in memory, accumulating Mendel errors per kid.
+//Loci are independent, so blocks are distributed over threads without any write conflict.
+//Siblings are then solved jointly, once the IBD states tracked along the variants are known at the start of each block.
+void genotype::solveVariants() {
+	if (mendel_thread.size() != pool->size()) {
+		mendel_thread = vector < vector < int > > (pool->size(), vector < int > (vec_names.size(), 0));
+		lock_thread = vector < vector < uint64_t > > (pool->size(), vector < uint64_t > (vec_names.size(), 0));
+		sib_thread = vector < unsigned int > (pool->size(), 0);
+	}
+	if (fdt) while (origin.size() < G.nBlocks()) origin.emplace_back(vec_names.size(), 0);
+	while (sib_own.size() < G.nBlocks()) sib_own.emplace_back(n_sib_slots, 0);
+	pool->run(G.nBlocks(), [&](unsigned int b, unsigned int t) { solveBlock(b, mendel_thread[t], lock_thread[t]); });
+	if (!sibships.empty()) {
+		carrySiblings();
+		pool->run(G.nBlocks(), [&](unsigned int b, unsigned int t) { sib_thread[t] += solveSiblings(b); });
+		for (int t = 0 ; t < sib_thread.size() ; t ++) { n_sib_phased += sib_thread[t]; sib_thread[t] = 0; }
+	}
+	if (fdt) trackTransmissions();
+	G.invalidate();
+	for (int t = 0 ; t < mendel_thread.size() ; t ++) for (int i = 0 ; i < vec_names.size() ; i ++) {
+		mendel_family[i] += mendel_thread[t][i];
+		mendel_thread[t][i] = 0;
+	}
+}
+
+void genotype::reportMendel() {
 	int n_trio = 0, n_fduo = 0, n_mduo = 0, n_mendel = 0;
 	mendel_error = vector < int > (vec_names.size(), 0);
 	mendel_total = vector < int > (vec_names.size(), 0);
 	for (int i = 0 ; i < vec_names.size() ; i++) {
-		//Trio case
+		int mendel = mendel_family[i];
 		if (fathers[i] >= 0 && mothers[i] >= 0) {
-			int mendel = 0;
-			for (int l = 0 ; l < gen1[i].size() ; l ++) {
-				if (!miss[i][l]) {
-					if (!miss[fathers[i]][l] && !miss[mothers[i]][l]) mendel += solveTrio(l, i, fathers[i], mothers[i]);
-					else if (!miss[fathers[i]][l]) mendel += solveDuoFather(l, i, fathers[i]);
-					else if (!miss[mothers[i]][l]) mendel += solveDuoMother(l, i, mothers[i]);
-				}
-			}
 			n_mendel += mendel;
 			mendel_error[fathers[i]] = mendel;
 			mendel_error[mothers[i]] = mendel;
 			mendel_error[i] = mendel;
 			n_trio ++;
 		}
-		//Duo father case
 		if (fathers[i] >= 0 && mothers[i] < 0) {
-			int mendel = 0;
-			for (int l = 0 ; l < gen1[i].size() ; l ++) {
-				if (!miss[i][l] && !miss[fathers[i]][l]) mendel += solveDuoFather(l, i, fathers[i]);
-			}
 			n_mendel += mendel;
 			mendel_error[fathers[i]] = mendel;
 			mendel_error[i] = mendel;
 			n_fduo ++;
 		}
-		//Duo mother case
 		if (fathers[i] < 0 && mothers[i] >= 0) {
-			int mendel = 0;
-			for (int l = 0 ; l < gen1[i].size() ; l ++) {
-				if (!miss[i][l] && !miss[mothers[i]][l]) mendel += solveDuoMother(l, i, mothers[i]);
-			}
 			n_mendel += mendel;
 			mendel_error[mothers[i]] = mendel;
 			mendel_error[i] = mendel;
@@ -131,4 +235,11 @@ void genotype::solvePedigrees() {
 		}
 	}
 	vrb.bullet("#mendel_errors = " + stb.str(n_mendel));
+	if (!sibships.empty()) vrb.bullet("#triple heterozygous genotypes phased using siblings = " + stb.str(n_sib_phased));
+}
+
+void genotype::solvePedigrees() {
+	vrb.title("Solving pedigrees");
+	solveVariants();
+	reportMendel();
 }
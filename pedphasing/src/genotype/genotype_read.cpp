@@ -3,38 +3,37 @@
 using namespace std;
 
 void genotype::readPedigrees(string fped) {
-	string buffer;
-	vector < string > str;
+	string_view buffer;
+	vector < string_view > str;
 	vrb.title("Reading pedigrees in [" + fped + "]");
-	input_file fd (fped);
+	bgzf_input_file fd (fped);
 	if (fd.fail()) vrb.error("Cannot open file!");
 	int n_unr = 0, n_duo = 0, n_tri = 0;
-	while (getline(fd, buffer)) {
-		stb.split(buffer, str);
-		map < string, int > :: iterator itC = map_names.find(str[0]);
-		map < string, int > :: iterator itF = map_names.find(str[1]);
-		map < string, int > :: iterator itM = map_names.find(str[2]);
-		if (itC != map_names.end()) {
-			if (itF != map_names.end()) fathers[itC->second] = itF->second;
-			else fathers[itC->second] = -1;
-			if (itM != map_names.end()) mothers[itC->second] = itM->second;
-			else mothers[itC->second] = -1;
-			int type = (fathers[itC->second] >= 0) + (mothers[itC->second] >= 0);
+	while (fd.getline(buffer)) {
+		if (stb.tokenize(buffer, str) == 0) continue;
+		if (str.size() < 3) vrb.error("Problem in pedigree file; each line should have 3 columns at least");
+		int c = map_names.find(str[0]);
+		if (c >= 0) {
+			fathers[c] = map_names.find(str[1]);
+			mothers[c] = map_names.find(str[2]);
+			int type = (fathers[c] >= 0) + (mothers[c] >= 0);
 			switch (type) {
 				case 2: n_tri ++; break;
 				case 1: n_duo ++; break;
-				default: n_tri ++; break;
+				default: n_unr ++; break;
 			}
 		}
 	}
 	vrb.bullet("#trios = " + stb.str(n_tri));
 	vrb.bullet("#duos = " + stb.str(n_duo));
 	vrb.bullet("#unrelateds = " + stb.str(n_unr));
+	sortPedigrees();
+	groupSiblings();
 }
 
-void genotype::readGenotypes(string fgen, string region) {
+void genotype::openReader(string fgen, string region) {
 	vrb.title("Reading genotypes in ["  + fgen + "]");
-	bcf_srs_t * sr =  bcf_sr_init();
+	sr =  bcf_sr_init();
 	if (region != "") {
 		if (bcf_sr_set_regions(sr, region.c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + region + "]");
 		else vrb.bullet("Jump to region [" + region + "] done");
@@ -42,51 +41,94 @@ void genotype::readGenotypes(string fgen, string region) {
 
 	//Read headers
 	if(!(bcf_sr_add_reader (sr, fgen.c_str()))) vrb.error("Impossible to read header of [" + fgen + "]");
+	if (!iop->attach(sr)) vrb.error("Impossible to attach threads to [" + fgen + "]");
 
 	//Genotype ids processing
 	int n_samples_gen = bcf_hdr_nsamples(sr->readers[0].header);
+	map_names.reserve(n_samples_gen);
+	vec_names.reserve(n_samples_gen);
 	for (int i = 0 ; i < n_samples_gen ; i ++) {
-		string sample_id = string(sr->readers[0].header->samples[i]);
-		map_names.insert(pair < string, int > (sample_id, vec_names.size()));
-		vec_names.push_back(sample_id);
+		map_names.insert(sr->readers[0].header->samples[i]);
+		vec_names.emplace_back(sr->readers[0].header->samples[i]);
 		fathers.push_back(-1);
 		mothers.push_back(-1);
 	}
 	vrb.bullet("#genotyped samples = " + stb.str(vec_names.size()));
 
+	int ncontigs = 0;
+	const char ** seqnames = bcf_hdr_seqnames(sr->readers[0].header, &ncontigs);
+	for (int c = 0 ; c < ncontigs ; c ++) contigs.push_back(string(seqnames[c]));
+	free(seqnames);
+
 	//Memory allocation
-	gen1 = vector < vector < bool > > (vec_names.size());
-	gen2 = vector < vector < bool > > (vec_names.size());
-	phas = vector < vector < bool > > (vec_names.size());
-	miss = vector < vector < bool > > (vec_names.size());
+	G.allocate(vec_names.size());
+	mendel_family = vector < int > (vec_names.size(), 0);
+	n_variant_tot = n_variant_set = 0;
+
+	//Scratch space of the decoding threads
+	stage_thread = vector < aligned_vector64 < uint64_t > > (pool->size(), aligned_vector64 < uint64_t > (G.stagingSize(), 0));
+	gt_arr_thread = vector < int * > (pool->size(), NULL);
+	ngt_arr_thread = vector < int > (pool->size(), 0);
+}
 
-	//Read genotype and haplotype data
-	int nset = 0, *gt_arr_gen = NULL, ngt_arr_gen = 0;
-	int n_variant_tot = 0, n_variant_set = 0;
-	bcf1_t * line_gen;
-	while ((nset = bcf_sr_next_line (sr))) {
-		line_gen =  bcf_sr_get_line(sr, 0);
-		if (line_gen->n_allele == 2) {
-			//
-			bcf_unpack(line_gen, BCF_UN_STR);
-			chr.push_back(bcf_hdr_id2name(sr->readers[0].header, line_gen->rid));
-			pos.push_back(line_gen->pos + 1);
-			id.push_back(string(line_gen->d.id));
-			ref.push_back(line_gen->d.allele[0]);
-			alt.push_back(line_gen->d.allele[1]);
-			//Extract genotypes
-			bcf_get_genotypes(sr->readers[0].header, line_gen, &gt_arr_gen, &ngt_arr_gen);
-			for(int h = 0 ; h < 2 * n_samples_gen ; h += 2) {
-				gen1[h/2].push_back(bcf_gt_allele(gt_arr_gen[h+0])!=0);
-				gen2[h/2].push_back(bcf_gt_allele(gt_arr_gen[h+1])!=0);
-				phas[h/2].push_back(bcf_gt_is_phased(gt_arr_gen[h+0]) && bcf_gt_is_phased(gt_arr_gen[h+1]));
-				miss[h/2].push_back(gt_arr_gen[h+0] == bcf_gt_missing || gt_arr_gen[h+1] == bcf_gt_missing);
+//Reads the next max_variants bi-allelic variants, replacing those currently in memory.
+//Records are gathered by chunks of a few blocks per thread, whose genotypes are then decoded in parallel.
+//When records are kept, they are swapped out of the reader so that they can be written back once solved.
+unsigned int genotype::readVariants(unsigned int max_variants) {
+	rid.clear(); pos.clear();
+	G.clear();
+
+	int nset = 1;
+	unsigned int chunk = 4 * pool->size() * GMAT_BLOCK;
+	while (nset && G.n_variants < max_variants) {
+		//Gather the records of the next chunk
+		unsigned int v0 = G.n_variants, base = keep_records ? v0 : 0;
+		unsigned int nmax = min(chunk, max_variants - v0);
+		unsigned int n = 0;
+		while (n < nmax && (nset = bcf_sr_next_line (sr))) {
+			bcf1_t * line_gen =  bcf_sr_get_line(sr, 0);
+			if (line_gen->n_allele == 2) {
+				rid.push_back(line_gen->rid);
+				pos.push_back(line_gen->pos + 1);
+				if (records.size() <= base + n) records.push_back(bcf_init1());
+				bcf_sr_swap_line(sr, 0, records[base + n]);
+				n ++;
 			}
-			n_variant_set ++;
+			n_variant_tot ++;
 		}
-		n_variant_tot ++;
+		n_variant_set += n;
+
+		//Decode their genotypes, one block per task; v0 is a multiple of the block size
+		G.resize(v0 + n);
+		pool->run(DIVU(n, GMAT_BLOCK), [&](unsigned int k, unsigned int t) {
+			decodeBlock(v0 / GMAT_BLOCK + k, t, &records[base + k * GMAT_BLOCK], min((unsigned int)GMAT_BLOCK, n - k * GMAT_BLOCK));
+		});
+	}
+	G.invalidate();
+	return G.n_variants;
+}
+
+//Decodes the genotypes of the n records of block b; run by decoding thread t
+void genotype::decodeBlock(unsigned int b, unsigned int t, bcf1_t ** recs, unsigned int n) {
+	uint64_t * stage = stage_thread[t].data();
+	for (unsigned int r = 0 ; r < n ; r ++) {
+		bcf_get_genotypes(sr->readers[0].header, recs[r], &gt_arr_thread[t], &ngt_arr_thread[t]);
+		G.encodeVariant(stage, r, gt_arr_thread[t]);
 	}
+	G.storeBlock(b, stage, n);
+}
+
+void genotype::closeReader() {
 	vrb.bullet("#variants: total = " + stb.str(n_variant_tot) + " / set = " + stb.str(n_variant_set));
-	free(gt_arr_gen);
-	bcf_sr_destroy(sr);
+	for (int t = 0 ; t < gt_arr_thread.size() ; t ++) free(gt_arr_thread[t]);
+	gt_arr_thread.clear(); ngt_arr_thread.clear();
+	bcf_sr_destroy(sr); sr = NULL;
+	for (int r = 0 ; r < records.size() ; r ++) bcf_destroy1(records[r]);
+	records.clear();
+}
+
+void genotype::readGenotypes(string fgen, string region) {
+	openReader(fgen, region);
+	readVariants(UINT_MAX);
+	closeReader();
 }
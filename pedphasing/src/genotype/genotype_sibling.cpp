@@ -0,0 +1,150 @@
+#include <genotype/genotype_header.h>
+
+using namespace std;
+
+//Groups full siblings, i.e. kids sharing both parents, in solving order: the first one is the reference
+//against which the identity-by-descent (IBD) states of the others are tracked for each parent
+void genotype::groupSiblings() {
+	sibships.clear();
+	sib_slot = vector < int > (vec_names.size(), -1);
+	map < pair < int, int >, int > parents2sibship;
+	for (int o = 0 ; o < order.size() ; o ++) {
+		int i = order[o];
+		if (fathers[i] < 0 || mothers[i] < 0) continue;
+		map < pair < int, int >, int > :: iterator it = parents2sibship.find(pair < int, int > (fathers[i], mothers[i]));
+		if (it == parents2sibship.end()) {
+			parents2sibship.insert(pair < pair < int, int >, int > (pair < int, int > (fathers[i], mothers[i]), sibships.size()));
+			sibships.push_back(vector < int > (1, i));
+		} else sibships[it->second].push_back(i);
+	}
+	sibships.erase(remove_if(sibships.begin(), sibships.end(), [](const vector < int > & s) { return s.size() < 2; }), sibships.end());
+	n_sib_slots = 0;
+	for (int s = 0 ; s < sibships.size() ; s ++) for (int k = 0 ; k < sibships[s].size() ; k ++) sib_slot[sibships[s][k]] = n_sib_slots ++;
+	ibd_state = vector < int > (2 * n_sib_slots, -1);
+	ibd_rid = vector < int > (2 * n_sib_slots, -1);
+	n_sib_phased = 0;
+	vrb.bullet("#sibships = " + stb.str(sibships.size()) + " / #siblings = " + stb.str(n_sib_slots));
+}
+
+//Loci of block b informative on the IBD state of sibling k with the reference for parent p (0 father, 1 mother):
+//the parent is heterozygous and both siblings got phased by their own trio, so the parental alleles they received are known.
+//Bits of val are set where the two siblings received different parental haplotypes.
+void genotype::informativeSiblings(unsigned int b, const vector < int > & sibship, int k, int p, uint64_t & inf, uint64_t & val) {
+	int r = sibship[0], i = sibship[k];
+	genotype_cell & P = G.get(b, p ? mothers[i] : fathers[i]);
+	genotype_cell & R = G.get(b, r);
+	genotype_cell & C = G.get(b, i);
+	inf = sib_own[b][sib_slot[r]] & sib_own[b][sib_slot[i]] & ~P.miss & (P.h0 ^ P.h1);
+	val = (p ? (R.h1 ^ C.h1) : (R.h0 ^ C.h0)) & inf;
+}
+
+//IBD state of sibling k with the reference for parent p at locus l of block b. The states of the last informative
+//locus up to l and of the first one from l on the same contig, possibly carried from other blocks, must agree:
+//a recombination between them or a genotype error at one of them would otherwise give a wrong state.
+//Returns -1 when unknown or when they disagree.
+int genotype::stateSiblings(unsigned int b, unsigned int l, int slot, int k, uint64_t inf, uint64_t val) {
+	if (k == 0) return 0;
+	unsigned int v0 = b * GMAT_BLOCK;
+	int prev, next;
+	uint64_t below = inf & ((2ULL << l) - 1);
+	uint64_t above = inf & ~((1ULL << l) - 1);
+	if (below) {
+		int q = 63 - __builtin_clzll(below);
+		prev = (rid[v0 + q] == rid[v0 + l]) ? ((val >> q) & 1ULL) : -1;
+	} else prev = (ibd_carry_rid[b][slot] == rid[v0 + l]) ? ibd_carry[b][slot] : -1;
+	if (above) {
+		int q = __builtin_ctzll(above);
+		next = (rid[v0 + q] == rid[v0 + l]) ? ((val >> q) & 1ULL) : -1;
+	} else next = (ibd_next_rid[b][slot] == rid[v0 + l]) ? ibd_next[b][slot] : -1;
+	return (prev == next) ? prev : -1;
+}
+
+//Forwards the IBD states through the blocks in memory: each block gets the states at its start.
+//The states at the end of the last block are kept for the next batch of variants.
+//Then backwards: each block gets the states at the first informative locus after it, unknown past the last block in memory.
+void genotype::carrySiblings() {
+	while (ibd_carry.size() < G.nBlocks()) {
+		ibd_carry.emplace_back(2 * n_sib_slots, -1);
+		ibd_carry_rid.emplace_back(2 * n_sib_slots, -1);
+		ibd_next.emplace_back(2 * n_sib_slots, -1);
+		ibd_next_rid.emplace_back(2 * n_sib_slots, -1);
+	}
+	for (int b = 0 ; b < G.nBlocks() ; b ++) {
+		unsigned int v0 = b * GMAT_BLOCK;
+		for (int s = 0 ; s < sibships.size() ; s ++) for (int k = 1 ; k < sibships[s].size() ; k ++) for (int p = 0 ; p < 2 ; p ++) {
+			int slot = 2 * sib_slot[sibships[s][k]] + p;
+			ibd_carry[b][slot] = ibd_state[slot];
+			ibd_carry_rid[b][slot] = ibd_rid[slot];
+			uint64_t inf, val;
+			informativeSiblings(b, sibships[s], k, p, inf, val);
+			if (inf) {
+				int q = 63 - __builtin_clzll(inf);
+				ibd_state[slot] = (val >> q) & 1ULL;
+				ibd_rid[slot] = rid[v0 + q];
+			}
+		}
+	}
+	for (int s = 0 ; s < sibships.size() ; s ++) for (int k = 1 ; k < sibships[s].size() ; k ++) for (int p = 0 ; p < 2 ; p ++) {
+		int slot = 2 * sib_slot[sibships[s][k]] + p, state = -1, state_rid = -1;
+		for (int b = G.nBlocks() - 1 ; b >= 0 ; b --) {
+			ibd_next[b][slot] = state;
+			ibd_next_rid[b][slot] = state_rid;
+			uint64_t inf, val;
+			informativeSiblings(b, sibships[s], k, p, inf, val);
+			if (inf) {
+				int q = __builtin_ctzll(inf);
+				state = (val >> q) & 1ULL;
+				state_rid = rid[b * GMAT_BLOCK + q];
+			}
+		}
+	}
+}
+
+//Phases the triple heterozygous loci of block b that trios leave unphased (kid and both parents heterozygous).
+//Another sibling phased at the locus gives the allele carried by each parental haplotype it received, and the IBD
+//states of the two siblings tell whether the kid received the same haplotypes: the kid is phased when both
+//parents agree on it. Loci whose IBD states are not supported on both sides are left unphased. Returns the number of loci phased this way.
+unsigned int genotype::solveSiblings(unsigned int b) {
+	unsigned int n_phased = 0;
+	vector < uint64_t > inf, val;
+	for (int s = 0 ; s < sibships.size() ; s ++) {
+		const vector < int > & sibship = sibships[s];
+		int n_sibs = sibship.size(), f = fathers[sibship[0]], m = mothers[sibship[0]];
+		genotype_cell & F = G.get(b, f);
+		genotype_cell & M = G.get(b, m);
+		uint64_t parents_het = ~F.miss & ~M.miss & (F.h0 ^ F.h1) & (M.h0 ^ M.h1);
+		if (!parents_het) continue;
+		inf.resize(2 * n_sibs); val.resize(2 * n_sibs);
+		for (int k = 1 ; k < n_sibs ; k ++) for (int p = 0 ; p < 2 ; p ++) informativeSiblings(b, sibship, k, p, inf[2 * k + p], val[2 * k + p]);
+		for (int k = 0 ; k < n_sibs ; k ++) {
+			int i = sibship[k], slot_i = 2 * sib_slot[i];
+			genotype_cell & C = G.get(b, i);
+			uint64_t targets = parents_het & ~C.miss & (C.h0 ^ C.h1) & ~sib_own[b][sib_slot[i]], resolved = 0;
+			while (targets) {
+				int l = __builtin_ctzll(targets);
+				targets &= targets - 1;
+				for (int j = 0 ; j < n_sibs ; j ++) {
+					int jj = sibship[j], slot_j = 2 * sib_slot[jj];
+					if (j == k || !((sib_own[b][sib_slot[jj]] >> l) & 1ULL)) continue;
+					int fk = stateSiblings(b, l, slot_i + 0, k, inf[2 * k + 0], val[2 * k + 0]);
+					int mk = stateSiblings(b, l, slot_i + 1, k, inf[2 * k + 1], val[2 * k + 1]);
+					int fj = stateSiblings(b, l, slot_j + 0, j, inf[2 * j + 0], val[2 * j + 0]);
+					int mj = stateSiblings(b, l, slot_j + 1, j, inf[2 * j + 1], val[2 * j + 1]);
+					if (fk < 0 || mk < 0 || fj < 0 || mj < 0) continue;
+					genotype_cell & J = G.get(b, jj);
+					uint64_t pat = ((J.h0 >> l) & 1ULL) ^ (fk ^ fj), mat = ((J.h1 >> l) & 1ULL) ^ (mk ^ mj);
+					if (pat != mat) {
+						resolved |= 1ULL << l;
+						C.h0 = (C.h0 & ~(1ULL << l)) | (pat << l);
+						C.h1 = (C.h1 & ~(1ULL << l)) | (mat << l);
+					}
+					break;
+				}
+			}
+			C.phas |= resolved;
+			if (fdt) origin[b][i] |= resolved;
+			n_phased += __builtin_popcountll(resolved);
+		}
+	}
+	return n_phased;
+}
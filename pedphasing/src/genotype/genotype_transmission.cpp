@@ -0,0 +1,87 @@
+#include <genotype/genotype_header.h>
+
+using namespace std;
+
+//Transmissions are tracked from the parents that are kids in the pedigree: their haplotypes
+//are grand-paternal|grand-maternal, so the transmitted one changes at each recombination
+void genotype::openTransmission(string prefix) {
+	for (int o = 0 ; o < order.size() ; o ++) {
+		int i = order[o];
+		if (fathers[i] >= 0 && (fathers[fathers[i]] >= 0 || mothers[fathers[i]] >= 0)) tracks.push_back(transmission_track {i, fathers[i], 0, -1, -1, -1});
+		if (mothers[i] >= 0 && (fathers[mothers[i]] >= 0 || mothers[mothers[i]] >= 0)) tracks.push_back(transmission_track {i, mothers[i], 1, -1, -1, -1});
+	}
+	vrb.bullet("#transmissions tracked = " + stb.str(tracks.size()));
+	if (tracks.empty()) vrb.warning("No parent with parents in the pedigree, transmission files will be empty");
+
+	fdt = new bgzf_output_file(prefix + ".trans.txt.gz", 1, 2, 3, iop->size(), compression_level, -1, iop->get());
+	fds = new bgzf_output_file(prefix + ".switch.txt.gz", 0, 0, 0, iop->size(), compression_level, -1, iop->get());
+	if (fdt->fail()) vrb.error(fdt->error);
+	if (fds->fail()) vrb.error(fds->error);
+	fdt->write("#CHR\tSTART\tEND\tKID\tPARENT\tROLE\tNINF\tNHAP0\tNHAP1\n");
+	fds->write("#CHR\tFROM\tTO\tKID\tPARENT\tROLE\tHAP_FROM\tHAP_TO\n");
+	n_switches = 0;
+}
+
+//Summarises, for each tracked transmission and block of variants in memory, the informative loci
+//transmitting each parental haplotype, and reports the changes of transmitted haplotype as switches
+void genotype::trackTransmissions() {
+	string record;
+	for (int b = 0 ; b < G.nBlocks() ; b ++) {
+		unsigned int vb = b * GMAT_BLOCK, vend = min(G.n_variants, vb + GMAT_BLOCK);
+		//Blocks are split where the contig changes
+		for (unsigned int v0 = vb, v1 = vb ; v0 < vend ; v0 = v1) {
+			while (v1 < vend && rid[v1] == rid[v0]) v1 ++;
+			uint64_t segment = ((v1 - v0 == 64) ? ~0ULL : ((1ULL << (v1 - v0)) - 1)) << (v0 - vb);
+			const string & chr = contigs[rid[v0]];
+			for (int t = 0 ; t < tracks.size() ; t ++) {
+				transmission_track & T = tracks[t];
+				genotype_cell & C = G.get(b, T.kid);
+				genotype_cell & P = G.get(b, T.parent);
+				//Informative loci: kid phased, parent heterozygous and phased against its own parents
+				uint64_t inf = C.phas & ~C.miss & ~P.miss & (P.h0 ^ P.h1) & origin[b][T.parent] & segment;
+				if (!inf) continue;
+				uint64_t hap = ((T.role ? C.h1 : C.h0) ^ P.h0) & inf;
+
+				//Block summary
+				int ninf = __builtin_popcountll(inf), nhap1 = __builtin_popcountll(hap);
+				record.clear();
+				record += chr; record += '\t';
+				stb.append(record, pos[v0]); record += '\t';
+				stb.append(record, pos[v1 - 1]); record += '\t';
+				record += vec_names[T.kid]; record += '\t';
+				record += vec_names[T.parent]; record += '\t';
+				record += T.role ? "MOTHER\t" : "FATHER\t";
+				stb.append(record, ninf); record += '\t';
+				stb.append(record, ninf - nhap1); record += '\t';
+				stb.append(record, nhap1); record += '\n';
+				fdt->write(chr, pos[v0] - 1, pos[v1 - 1], record);
+
+				//Switches between consecutive informative loci, possibly across blocks and batches
+				for (uint64_t bits = inf ; bits ; bits &= bits - 1) {
+					int r = __builtin_ctzll(bits), h = (hap >> r) & 1, p = pos[vb + r];
+					if (T.last_hap >= 0 && T.last_rid == rid[v0] && T.last_hap != h) {
+						record.clear();
+						record += chr; record += '\t';
+						stb.append(record, T.last_pos); record += '\t';
+						stb.append(record, p); record += '\t';
+						record += vec_names[T.kid]; record += '\t';
+						record += vec_names[T.parent]; record += '\t';
+						record += T.role ? "MOTHER\t" : "FATHER\t";
+						stb.append(record, T.last_hap); record += '\t';
+						stb.append(record, h); record += '\n';
+						fds->write(record);
+						n_switches ++;
+					}
+					T.last_hap = h; T.last_pos = p; T.last_rid = rid[v0];
+				}
+			}
+		}
+	}
+}
+
+void genotype::closeTransmission() {
+	if (fdt->close() < 0 || fds->close() < 0) vrb.error("Failed to write transmission files");
+	delete fdt; fdt = NULL;
+	delete fds; fds = NULL;
+	vrb.bullet("#switches = " + stb.str(n_switches));
+}
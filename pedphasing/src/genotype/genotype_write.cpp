@@ -2,71 +2,94 @@
 
 using namespace std;
 
-#define OFILE_VCFU	0
-#define OFILE_VCFC	1
-#define OFILE_BCFC	2
-
-
-void genotype::writeGenotypes(string filename) {
+//Output header is the input one, so that all INFO/FORMAT fields are kept
+void genotype::openWriter(string filename, bcf_hdr_t * hdr_in) {
 	// Init
 	vrb.title("Writing genotypes in ["  + filename + "]");
 
-	string file_format = "w";
-	unsigned int file_type = OFILE_VCFU;
-	if (filename.size() > 6 && filename.substr(filename.size()-6) == "vcf.gz") { file_format = "wz"; file_type = OFILE_VCFC; }
-	if (filename.size() > 3 && filename.substr(filename.size()-3) == "bcf") { file_format = "wb"; file_type = OFILE_BCFC; }
-	htsFile * fp = hts_open(filename.c_str(),file_format.c_str());
-	bcf_hdr_t * hdr = bcf_hdr_init("w");
-	bcf1_t *rec    = bcf_init1();
+	hdr = bcf_hdr_dup(hdr_in);
+	if (!out.open(filename, hdr, iop, write_index, output_type, compression_level)) vrb.error(out.error);
 
-	// Create VCF header
-	bcf_hdr_append(hdr, "##source=makeScaffold");
+	//Scratch space of the encoding threads
+	stage_thread = vector < aligned_vector64 < uint64_t > > (pool->size(), aligned_vector64 < uint64_t > (G.stagingSize(), 0));
+	gt_thread = vector < vector < int > > (pool->size(), vector < int > (2 * bcf_hdr_nsamples(hdr), 0));
+	patched_thread = vector < unsigned int > (pool->size(), 0);
+}
 
-	string pchr = chr[0];
-	bcf_hdr_append(hdr, string("##contig=<ID="+ pchr + ">").c_str());
-	for (int v = 1 ; v < chr.size() ; v++) if (chr[v] != pchr) {
-		pchr = chr[v];
-		bcf_hdr_append(hdr, string("##contig=<ID="+ pchr + ">").c_str());
+//Overwrites the GT field of a record with the given genotypes.
+//Diploid GTs encoded on int8 are patched in place in the packed FORMAT data, leaving all other fields untouched.
+bool genotype::patchRecord(bcf1_t * rec, int * gts) {
+	int nsamples = bcf_hdr_nsamples(hdr);
+	bcf_fmt_t * fmt = bcf_get_fmt(hdr, rec, "GT");
+	if (fmt && fmt->type == BCF_BT_INT8 && fmt->n == 2) {
+		int8_t * p = (int8_t *)fmt->p;
+		for (int h = 0 ; h < 2 * nsamples ; h ++) p[h] = gts[h];
+		return true;
 	}
-	bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotypes\">");
+	bcf_update_genotypes(hdr, rec, gts, nsamples*2);
+	return false;
+}
+
+//Encodes the solved genotypes of block b into the n records of its variants; run by encoding thread t
+void genotype::patchBlock(unsigned int b, unsigned int t, bcf1_t ** recs, unsigned int n) {
+	uint64_t * stage = stage_thread[t].data();
+	int * gts = gt_thread[t].data();
+	G.loadBlock(b, stage);
+	for (unsigned int r = 0 ; r < n ; r ++) {
+		G.decodeVariant(stage, r, gts);
+		patched_thread[t] += patchRecord(recs[r], gts);
+	}
+}
 
-	//Add samples
-	for (int i = 0 ; i < vec_names.size() ; i ++) bcf_hdr_add_sample(hdr, vec_names[i].c_str());
-	bcf_hdr_add_sample(hdr, NULL);      // to update internal structures
-	bcf_hdr_write(fp, hdr);
+//Records of the blocks [b0, b0 + nblocks) are encoded in parallel, then serialized in order by the calling thread
+void genotype::writeBlocks(unsigned int b0, unsigned int nblocks, unsigned int nrecords) {
+	pool->run(nblocks, [&](unsigned int k, unsigned int t) {
+		patchBlock(b0 + k, t, &records[k * GMAT_BLOCK], min((unsigned int)GMAT_BLOCK, nrecords - k * GMAT_BLOCK));
+	});
+	for (unsigned int r = 0 ; r < nrecords ; r ++) if (!out.write(hdr, records[r])) vrb.error("Failed to write record");
+}
+
+//Writes the variants currently in memory, from the records kept while reading
+void genotype::writeVariants() {
+	writeBlocks(0, G.nBlocks(), G.n_variants);
+}
 
-	//Add records
-	int * genotypes = (int*)malloc(bcf_hdr_nsamples(hdr)*2*sizeof(int));
-	for (int l = 0 ; l < chr.size() ; l ++) {
-		bcf_clear1(rec);
-		rec->rid = bcf_hdr_name2id(hdr,chr[l].c_str());
-		rec->pos = pos[l] - 1;
-		bcf_update_id(hdr, rec, id[l].c_str());
-		string alleles = ref[l] + "," + alt[l];
-		bcf_update_alleles_str(hdr, rec, alleles.c_str());
-		for (int i = 0 ; i < vec_names.size() ; i++) {
-			if (miss[i][l]) {
-				genotypes[2*i+0] = bcf_gt_missing;
-				genotypes[2*i+1] = bcf_gt_missing;
-			} else if (phas[i][l]) {
-				genotypes[2*i+0] = bcf_gt_phased(gen1[i][l]);
-				genotypes[2*i+1] = bcf_gt_phased(gen2[i][l]);
-			} else {
-				genotypes[2*i+0] = bcf_gt_unphased(gen1[i][l]);
-				genotypes[2*i+1] = bcf_gt_unphased(gen2[i][l]);
+void genotype::closeWriter() {
+	if (!out.close()) vrb.error("Non zero status when closing VCF/BCF file descriptor or saving its index");
+	bcf_hdr_destroy(hdr); hdr = NULL;
+	vrb.bullet(out.format() + " writing [" + out.compression() + " / N=" + stb.str(vec_names.size()) + " / L=" + stb.str(out.n_records) + "]");
+	if (out.indexed) vrb.bullet("Index written in [" + out.fnidx + "]");
+	unsigned int n_variant_patched = 0;
+	for (int t = 0 ; t < patched_thread.size() ; t ++) n_variant_patched += patched_thread[t];
+	vrb.bullet("#records with GT patched in place = " + stb.str(n_variant_patched));
+}
+
+//Records are not kept in memory for a whole region: the input is read a second time, by chunks of
+//blocks whose records are kept in the pool, encoded in parallel and written out
+void genotype::writeGenotypes(string filename, string fgen, string region) {
+	bcf_srs_t * sr_in =  bcf_sr_init();
+	if (region != "" && bcf_sr_set_regions(sr_in, region.c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + region + "]");
+	if(!(bcf_sr_add_reader (sr_in, fgen.c_str()))) vrb.error("Impossible to read header of [" + fgen + "]");
+	if (!iop->attach(sr_in)) vrb.error("Impossible to attach threads to [" + fgen + "]");
+	openWriter(filename, sr_in->readers[0].header);
+	unsigned int chunk = 4 * pool->size() * GMAT_BLOCK, v = 0, n = chunk;
+	while (n == chunk) {
+		n = 0;
+		while (n < chunk && bcf_sr_next_line (sr_in)) {
+			bcf1_t * line = bcf_sr_get_line(sr_in, 0);
+			if (line->n_allele == 2) {
+				if (v + n >= G.n_variants || line->rid != rid[v + n] || line->pos + 1 != pos[v + n]) vrb.error("Input changed since it was read [" + fgen + "]");
+				if (records.size() <= n) records.push_back(bcf_init1());
+				bcf_sr_swap_line(sr_in, 0, records[n]);
+				n ++;
 			}
 		}
-		bcf_update_genotypes(hdr, rec, genotypes, bcf_hdr_nsamples(hdr)*2);
-		bcf_write1(fp, hdr, rec);
-	}
-	free(genotypes);
-	bcf_destroy1(rec);
-	bcf_hdr_destroy(hdr);
-	if (hts_close(fp)) vrb.error("Non zero status when closing VCF/BCF file descriptor");
-
-	switch (file_type) {
-	case OFILE_VCFU: vrb.bullet("VCF writing [Uncompressed / N=" + stb.str(vec_names.size()) + " / L=" + stb.str(chr.size()) + "]"); break;
-	case OFILE_VCFC: vrb.bullet("VCF writing [Compressed / N=" + stb.str(vec_names.size()) + " / L=" + stb.str(chr.size()) + "]"); break;
-	case OFILE_BCFC: vrb.bullet("BCF writing [Compressed / N=" + stb.str(vec_names.size()) + " / L=" + stb.str(chr.size()) + "]"); break;
+		writeBlocks(v / GMAT_BLOCK, DIVU(n, GMAT_BLOCK), n);
+		v += n;
 	}
+	if (v != G.n_variants) vrb.error("Input changed since it was read [" + fgen + "]");
+	closeWriter();
+	bcf_sr_destroy(sr_in);
+	for (int r = 0 ; r < records.size() ; r ++) bcf_destroy1(records[r]);
+	records.clear();
 }
@@ -25,6 +25,8 @@
 
 #include <utils/otools.h>
 
+class genotype;
+
 class phaser {
 public:
 	//COMMAND LINE OPTIONS
@@ -46,6 +48,7 @@ public:
 
 	//
 	void phase();
+	void selectStrategy(genotype &, bool &, unsigned int &);
 	void phase(std::vector < std::string > & args);
 };
 
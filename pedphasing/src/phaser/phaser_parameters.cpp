@@ -36,12 +36,22 @@ void phaser::declare_options() {
 			("pedigree", bpo::value< string >(), "Pedigree file (kid father mother)")
 			("region", bpo::value< string >(), "Genomic region");
 
+	bpo::options_description opt_algo ("Parameters");
+	opt_algo.add_options()
+			("streaming", "Solve and write variants in batches instead of loading the whole region in memory")
+			("batch", bpo::value< int >()->default_value(8192), "Number of variants per batch in streaming mode")
+			("max-memory", bpo::value< int >(), "Memory budget in Mb: streaming and its batch size are then chosen automatically to fit in");
+
 	bpo::options_description opt_output ("Output files");
 	opt_output.add_options()
-			("output", bpo::value< string >(), "Output genotypes in VCF/BCF format")
+			("output", bpo::value< string >(), "Output genotypes in VCF/BCF format, - for stdout")
+			("output-type", bpo::value< string >(), "Output type: v (VCF), z (compressed VCF), u (uncompressed BCF) or b (compressed BCF); from the file extension by default")
+			("compression-level", bpo::value< int >(), "Compression level of the outputs, from 0 (fastest) to 9 (smallest); htslib default otherwise")
+			("write-index", "Index the compressed output (CSI) while writing it")
+			("transmission", bpo::value< string >(), "Track transmitted haplotypes in [prefix.trans.txt.gz] and their switches in [prefix.switch.txt.gz]")
 			("log", bpo::value< string >(), "Log file");
 
-	descriptions.add(opt_base).add(opt_input).add(opt_output);
+	descriptions.add(opt_base).add(opt_input).add(opt_algo).add(opt_output);
 }
 
 void phaser::parse_command_line(vector < string > & args) {
@@ -52,6 +62,9 @@ void phaser::parse_command_line(vector < string > & args) {
 
 	if (options.count("help")) { cout << descriptions << endl; exit(0); }
 
+	//Records go to stdout: keep it clean of messages
+	if (options.count("output") && options["output"].as < string > () == "-") vrb.set_stderr();
+
 	if (options.count("log") && !vrb.open_log(options["log"].as < string > ()))
 		vrb.error("Impossible to create log file [" + options["log"].as < string > () +"]");
 
@@ -69,11 +82,27 @@ void phaser::check_options() {
 	if (!options.count("output"))
 		vrb.error("You must specify --output");
 
+	if (options["input"].as < string > () == "-")
+		vrb.error("--input cannot be stdin: the input is read several times and jumped into with its index");
+
 	if (!options.count("region"))
 		vrb.error("You must specify --region");
 
 	if (!options.count("pedigree"))
 		vrb.error("You must specify --pedigree");
+
+	if (options["thread"].as < int > () <= 0)
+		vrb.error("--thread must be a positive number");
+
+	if (options["batch"].as < int > () <= 0)
+		vrb.error("--batch must be a positive number of variants");
+
+	if (options.count("max-memory") && options["max-memory"].as < int > () <= 0)
+		vrb.error("--max-memory must be a positive number of Mb");
+
+	//Same checks as when the outputs are opened, which only happens once pedigrees are solved without --streaming
+	string error = vcf_output_file::check(options.count("output-type") ? options["output-type"].as < string > () : "", options.count("compression-level") ? options["compression-level"].as < int > () : -1);
+	if (error != "") vrb.error(error);
 }
 
 void phaser::verbose_files() {
@@ -81,9 +110,16 @@ void phaser::verbose_files() {
 	vrb.bullet("Input VCF     : [" + options["input"].as < string > () + "]");
 	vrb.bullet("Input FAM     : [" + options["pedigree"].as < string > () + "]");
 	vrb.bullet("Output VCF    : [" + options["output"].as < string > () + "]");
+	if (options.count("output-type")) vrb.bullet("Output type   : [" + options["output-type"].as < string > () + "]");
+	if (options.count("write-index")) vrb.bullet("Output index  : [" + options["output"].as < string > () + ".csi]");
+	if (options.count("transmission")) vrb.bullet("Output TRANS  : [" + options["transmission"].as < string > () + ".trans/switch.txt.gz]");
 }
 
 void phaser::verbose_options() {
 	vrb.title("Parameters:");
+	if (options.count("compression-level")) vrb.bullet("Compression   : [level " + stb.str(options["compression-level"].as < int > ()) + " / " + vcf_output_file::backend() + "]");
 	vrb.bullet("Region        : [" + options["region"].as < string > () + "]");
+	vrb.bullet("#Threads      : [" + stb.str(options["thread"].as < int > ()) + "]");
+	if (options.count("streaming")) vrb.bullet("Streaming     : [" + stb.str(options["batch"].as < int > ()) + " variants per batch]");
+	if (options.count("max-memory")) vrb.bullet("Max memory    : [" + stb.str(options["max-memory"].as < int > ()) + " Mb]");
 }
@@ -28,12 +28,67 @@ using namespace std;
 void phaser::phase() {
 	tac.clock();
 
-	genotype D;
-	D.readGenotypes(options["input"].as < string > (), options["region"].as < string > ());
-	D.readPedigrees(options["pedigree"].as < string > ());
-	D.solvePedigrees();
-	D.writeGenotypes(options["output"].as < string > ());
+	genotype D(options["thread"].as < int > ());
+	D.write_index = options.count("write-index") > 0;
+	if (options.count("output-type")) D.output_type = options["output-type"].as < string > ();
+	if (options.count("compression-level")) D.compression_level = options["compression-level"].as < int > ();
+	bool streaming = options.count("streaming") > 0;
+	unsigned int batch = options["batch"].as < int > ();
+	if (options.count("max-memory")) selectStrategy(D, streaming, batch);
+
+	if (streaming) {
+		//Memory is bounded by one batch of variants: read, solve and write batch after batch
+		D.keep_records = true;
+		D.openReader(options["input"].as < string > (), options["region"].as < string > ());
+		D.readPedigrees(options["pedigree"].as < string > ());
+		if (options.count("transmission")) D.openTransmission(options["transmission"].as < string > ());
+		D.openWriter(options["output"].as < string > (), D.sr->readers[0].header);
+		vrb.title("Solving pedigrees in batches of " + stb.str(batch) + " variants");
+		unsigned int nbatches = 0;
+		while (D.readVariants(batch)) {
+			D.solveVariants();
+			D.writeVariants();
+			if (++nbatches % 10 == 0) vrb.bullet("Processed batches: [" + stb.str(nbatches) + "]");
+		}
+		D.closeWriter();
+		D.closeReader();
+		D.reportMendel();
+		if (options.count("transmission")) D.closeTransmission();
+	} else {
+		D.readGenotypes(options["input"].as < string > (), options["region"].as < string > ());
+		D.readPedigrees(options["pedigree"].as < string > ());
+		if (options.count("transmission")) D.openTransmission(options["transmission"].as < string > ());
+		D.solvePedigrees();
+		if (options.count("transmission")) D.closeTransmission();
+		D.writeGenotypes(options["output"].as < string > (), options["input"].as < string > (), options["region"].as < string > ());
+	}
 
 	vrb.title("Total running time = " + stb.str(tac.abs_time()) + " seconds");
 
 }
+
+//Picks in-memory solving when the whole region fits in the memory budget, streaming otherwise,
+//with the largest batch (up to --batch) that fits in
+void phaser::selectStrategy(genotype & D, bool & streaming, unsigned int & batch) {
+	vrb.title("Estimating memory usage");
+	unsigned long budget = options["max-memory"].as < int > () * 1024UL * 1024UL;
+	bool transmission = options.count("transmission") > 0;
+	bool counted = D.estimateMemory(options["input"].as < string > (), options["region"].as < string > (), options["pedigree"].as < string > ());
+	vrb.bullet("#samples = " + stb.str(D.est_samples) + " / #siblings = " + stb.str(D.est_sib_slots) + " / record size = " + stb.str(D.est_record_bytes / 1024.0, 1) + " Kb");
+	if (!counted) {
+		vrb.warning("Index of [" + options["input"].as < string > () + "] has no record counts, streaming is used");
+		streaming = true;
+	} else {
+		unsigned long mem_all = D.memoryInMemory(transmission);
+		vrb.bullet("#records in region ~ " + stb.str(D.est_variants) + " / in-memory ~ " + stb.str(mem_all / 1048576.0, 1) + " Mb");
+		if (!streaming && mem_all <= budget) {
+			vrb.bullet("Strategy = in-memory, fits in " + stb.str(options["max-memory"].as < int > ()) + " Mb");
+			return;
+		}
+		streaming = true;
+	}
+	while (batch > GMAT_BLOCK && D.memoryStreaming(batch, transmission) > budget) batch = max((unsigned int)GMAT_BLOCK, (batch / 2) / GMAT_BLOCK * GMAT_BLOCK);
+	unsigned long mem_batch = D.memoryStreaming(batch, transmission);
+	vrb.bullet("Strategy = streaming by " + stb.str(batch) + " variants ~ " + stb.str(mem_batch / 1048576.0, 1) + " Mb");
+	if (mem_batch > budget) vrb.warning("Smallest batch does not fit in " + stb.str(options["max-memory"].as < int > ()) + " Mb");
+}
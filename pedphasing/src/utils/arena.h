@@ -0,0 +1 @@
+../../../common/src/utils/arena.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../common/src/utils/vcf_record.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../common/src/utils/io_pool.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../common/src/utils/sample_index.h
\ No newline at end of file